@@ -0,0 +1,146 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+// CRC32C (Castagnoli), as used by the per-chunk CRC words of Gw2.dat entries.
+// Uses the SSE4.2 / ARMv8 CRC instructions when the CPU has them, slicing-by-8 tables otherwise.
+class Crc32c {
+public:
+	// Pass a previous result as crc to continue a checksum over split buffers
+	static uint32_t compute(const uint8_t* data, size_t size, uint32_t crc = 0) {
+		crc = ~crc;
+#if defined(CRC32C_X86)
+		if (hasHardwareSupport()) {
+			return ~computeHardware(data, size, crc);
+		}
+#elif defined(CRC32C_ARM)
+		return ~computeHardware(data, size, crc);
+#endif
+		return ~computeSoftware(data, size, crc);
+	}
+
+	static bool hasHardwareSupport() {
+#if defined(CRC32C_X86)
+		static const bool supported = detectSse42();
+		return supported;
+#elif defined(CRC32C_ARM)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+private:
+	struct Tables {
+		uint32_t table[8][256];
+
+		Tables() {
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; ++bit) {
+					crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+				}
+				table[0][i] = crc;
+			}
+			for (uint32_t i = 0; i < 256; ++i) {
+				for (int slice = 1; slice < 8; ++slice) {
+					table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+				}
+			}
+		}
+	};
+
+	static uint32_t computeSoftware(const uint8_t* data, size_t size, uint32_t crc) {
+		static const Tables tables;
+		const auto& table = tables.table;
+
+		while (size >= 8) {
+			uint32_t low;
+			uint32_t high;
+			std::memcpy(&low, data, 4);
+			std::memcpy(&high, data + 4, 4);
+			low ^= crc;
+			crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+				table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+				table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+				table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+			data += 8;
+			size -= 8;
+		}
+		while (size-- > 0) {
+			crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF];
+		}
+		return crc;
+	}
+
+#if defined(CRC32C_X86)
+	static bool detectSse42() {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 20)) != 0;
+#else
+		return __builtin_cpu_supports("sse4.2");
+#endif
+	}
+
+#if !defined(_MSC_VER)
+	__attribute__((target("sse4.2")))
+#endif
+	static uint32_t computeHardware(const uint8_t* data, size_t size, uint32_t crc) {
+#if defined(__x86_64__) || defined(_M_X64)
+		uint64_t crc64 = crc;
+		while (size >= 8) {
+			uint64_t value;
+			std::memcpy(&value, data, 8);
+			crc64 = _mm_crc32_u64(crc64, value);
+			data += 8;
+			size -= 8;
+		}
+		crc = static_cast<uint32_t>(crc64);
+#endif
+		while (size >= 4) {
+			uint32_t value;
+			std::memcpy(&value, data, 4);
+			crc = _mm_crc32_u32(crc, value);
+			data += 4;
+			size -= 4;
+		}
+		while (size-- > 0) {
+			crc = _mm_crc32_u8(crc, *data++);
+		}
+		return crc;
+	}
+#elif defined(CRC32C_ARM)
+	static uint32_t computeHardware(const uint8_t* data, size_t size, uint32_t crc) {
+		while (size >= 8) {
+			uint64_t value;
+			std::memcpy(&value, data, 8);
+			crc = __crc32cd(crc, value);
+			data += 8;
+			size -= 8;
+		}
+		while (size-- > 0) {
+			crc = __crc32cb(crc, *data++);
+		}
+		return crc;
+	}
+#endif
+};
+
+#endif // !CRC32C_H
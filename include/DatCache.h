@@ -0,0 +1,269 @@
+#ifndef DAT_CACHE_H
+#define DAT_CACHE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <climits>
+#endif
+
+#include "MappedFile.h"
+#include "Crc32c.h"
+
+// Sidecar cache of the parsed tables of one archive.
+//
+// Caches live in a per-user directory (see directory()) rather than next to the archive, whose
+// folder is usually read-only, and are named after the archive's absolute path.
+//
+// Holds the raw MFT header, MFT table and index table plus the serialized search index, so a
+// warm start reads one small contiguous file instead of scattered archive ranges and skips
+// building the search index. The cache is tied to the archive by the DAT header CRC, the MFT
+// offset, the file size and the modification time; any mismatch, a different format version
+// or a failed checksum makes it stale and it is rebuilt.
+class DatCache {
+public:
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+	struct Key {
+		uint32_t header_crc = 0;
+		uint64_t mft_offset = 0;
+		uint64_t file_size = 0;
+		int64_t modification_time = 0;
+
+		bool operator==(const Key& other) const {
+			return header_crc == other.header_crc && mft_offset == other.mft_offset &&
+				file_size == other.file_size && modification_time == other.modification_time;
+		}
+	};
+
+	struct Sections {
+		ByteSpan mft_header;
+		ByteSpan mft_table;
+		ByteSpan index_table;
+		ByteSpan search_index;
+	};
+
+	// $GW2VIEWER_CACHE_DIR when set, otherwise %LOCALAPPDATA%\GW2Viewer\Cache on Windows and
+	// $XDG_CACHE_HOME/gw2viewer or ~/.cache/gw2viewer elsewhere; empty when none can be found
+	static std::string directory() {
+		if (const char* override_directory = std::getenv("GW2VIEWER_CACHE_DIR")) {
+			return override_directory;
+		}
+#ifdef _WIN32
+		const char* local_app_data = std::getenv("LOCALAPPDATA");
+		return local_app_data ? std::string(local_app_data) + "\\GW2Viewer\\Cache" : std::string();
+#else
+		const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+		if (xdg_cache && xdg_cache[0] == '/') {
+			return std::string(xdg_cache) + "/gw2viewer";
+		}
+		const char* home = std::getenv("HOME");
+		return home ? std::string(home) + "/.cache/gw2viewer" : std::string();
+#endif
+	}
+
+	// Name shared by every cache file of one archive: its file name plus a hash of its absolute
+	// path, so equally named archives in different folders do not collide
+	static std::string archiveTag(const std::string& archive_path) {
+		std::string absolute_path = archive_path;
+#ifdef _WIN32
+		char buffer[_MAX_PATH];
+		if (_fullpath(buffer, archive_path.c_str(), sizeof(buffer))) {
+			absolute_path = buffer;
+		}
+#else
+		char buffer[PATH_MAX];
+		if (realpath(archive_path.c_str(), buffer)) {
+			absolute_path = buffer;
+		}
+#endif
+		size_t name_start = archive_path.find_last_of("/\\");
+		std::string name = name_start == std::string::npos ? archive_path : archive_path.substr(name_start + 1);
+		char hash[9];
+		std::snprintf(hash, sizeof(hash), "%08x", Crc32c::compute(reinterpret_cast<const uint8_t*>(absolute_path.data()), absolute_path.size()));
+		return name + "-" + hash;
+	}
+
+	// Falls back to <archive>.cache when there is no per-user directory
+	static std::string pathFor(const std::string& archive_path) {
+		std::string cache_directory = directory();
+		if (cache_directory.empty()) {
+			return archive_path + ".cache";
+		}
+		return cache_directory + "/" + archiveTag(archive_path) + ".cache";
+	}
+
+	// Creates path and its missing parents; true when it exists afterwards
+	static bool makeDirectories(const std::string& path) {
+		size_t separator = 0;
+		while (true) {
+			separator = path.find_first_of("/\\", separator + 1);
+			std::string prefix = path.substr(0, separator);
+#ifdef _WIN32
+			int result = _mkdir(prefix.c_str());
+#else
+			int result = mkdir(prefix.c_str(), 0755);
+#endif
+			// Failures on the parents (drive roots, folders that exist) only matter at the end
+			if (separator == std::string::npos) {
+				return result == 0 || errno == EEXIST;
+			}
+		}
+	}
+
+	// True when a file could be created in the folder of path, which is created if missing.
+	// Checked before a cache is built, so a read-only location costs nothing.
+	static bool canWrite(const std::string& path) {
+		size_t separator = path.find_last_of("/\\");
+		std::string folder = separator == std::string::npos ? std::string(".") : path.substr(0, separator);
+		if (separator != std::string::npos && !makeDirectories(folder)) {
+			return false;
+		}
+#ifdef _WIN32
+		return _access(folder.c_str(), 2) == 0;
+#else
+		return access(folder.c_str(), W_OK) == 0;
+#endif
+	}
+
+	// Seconds since the epoch, or -1 if the file cannot be inspected
+	static int64_t modificationTime(const std::string& path) {
+#ifdef _WIN32
+		struct _stat64 file_stat;
+		if (_stat64(path.c_str(), &file_stat) != 0) {
+			return -1;
+		}
+#else
+		struct stat file_stat;
+		if (stat(path.c_str(), &file_stat) != 0) {
+			return -1;
+		}
+#endif
+		return static_cast<int64_t>(file_stat.st_mtime);
+	}
+
+	// Maps the cache and checks it belongs to key; the sections stay valid until close()
+	bool open(const std::string& cache_path, const Key& key) {
+		close();
+		if (!mapped_file.open(cache_path)) {
+			return false;
+		}
+
+		// The whole cache is checksummed and copied out, so read it in one go
+		mapped_file.willNeed(0, mapped_file.size());
+		ByteSpan file(mapped_file.data(), mapped_file.size());
+		if (file.size < HEADER_SIZE || loadField<uint32_t>(file.data, 0) != MAGIC ||
+			loadField<uint32_t>(file.data, 4) != FORMAT_VERSION) {
+			close();
+			return false;
+		}
+
+		Key cached_key;
+		cached_key.header_crc = loadField<uint32_t>(file.data, 8);
+		cached_key.mft_offset = loadField<uint64_t>(file.data, 16);
+		cached_key.file_size = loadField<uint64_t>(file.data, 24);
+		cached_key.modification_time = loadField<int64_t>(file.data, 32);
+		uint32_t checksum = loadField<uint32_t>(file.data, 12);
+
+		ByteSpan payload = file.subspan(HEADER_SIZE, file.size - HEADER_SIZE);
+		if (!(cached_key == key) || Crc32c::compute(payload.data, payload.size) != checksum) {
+			close();
+			return false;
+		}
+
+		// Sections are stored as (u64 size, bytes)
+		ByteSpan* section_list[] = { &sections.mft_header, &sections.mft_table, &sections.index_table, &sections.search_index };
+		size_t position = 0;
+		for (ByteSpan* section : section_list) {
+			if (payload.size - position < sizeof(uint64_t)) {
+				close();
+				return false;
+			}
+			uint64_t section_size = loadField<uint64_t>(payload.data, position);
+			position += sizeof(uint64_t);
+			if (section_size > payload.size - position) {
+				close();
+				return false;
+			}
+			*section = payload.subspan(position, static_cast<size_t>(section_size));
+			position += static_cast<size_t>(section_size);
+		}
+		return true;
+	}
+
+	const Sections& getSections() const {
+		return sections;
+	}
+
+	void close() {
+		mapped_file.close();
+		sections = Sections();
+	}
+
+	// Writes under a temporary name and renames, so readers never see a partial cache
+	static bool write(const std::string& cache_path, const Key& key, const Sections& new_sections) {
+		const ByteSpan section_list[] = { new_sections.mft_header, new_sections.mft_table, new_sections.index_table, new_sections.search_index };
+
+		uint32_t checksum = 0;
+		for (const ByteSpan& section : section_list) {
+			uint64_t section_size = section.size;
+			checksum = Crc32c::compute(reinterpret_cast<const uint8_t*>(&section_size), sizeof(section_size), checksum);
+			checksum = Crc32c::compute(section.data, section.size, checksum);
+		}
+
+		uint8_t header[HEADER_SIZE] = {};
+		storeField<uint32_t>(header, 0, MAGIC);
+		storeField<uint32_t>(header, 4, FORMAT_VERSION);
+		storeField<uint32_t>(header, 8, key.header_crc);
+		storeField<uint32_t>(header, 12, checksum);
+		storeField<uint64_t>(header, 16, key.mft_offset);
+		storeField<uint64_t>(header, 24, key.file_size);
+		storeField<int64_t>(header, 32, key.modification_time);
+
+		std::string temporary_path = cache_path + ".part";
+		{
+			std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+			output.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+			for (const ByteSpan& section : section_list) {
+				uint64_t section_size = section.size;
+				output.write(reinterpret_cast<const char*>(&section_size), sizeof(section_size));
+				output.write(reinterpret_cast<const char*>(section.data), section.size);
+			}
+			if (!output) {
+				output.close();
+				std::remove(temporary_path.c_str());
+				return false;
+			}
+		}
+
+		std::remove(cache_path.c_str());
+		if (std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+			std::remove(temporary_path.c_str());
+			return false;
+		}
+		return true;
+	}
+
+private:
+	// magic, version, header crc, payload checksum, mft offset, file size, mtime
+	static constexpr size_t HEADER_SIZE = 40;
+	static constexpr uint32_t MAGIC = 0x43565747; // "GWVC"
+
+	MappedFile mapped_file;
+	Sections sections;
+};
+
+#endif // !DAT_CACHE_H
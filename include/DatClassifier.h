@@ -0,0 +1,248 @@
+#ifndef DAT_CLASSIFIER_H
+#define DAT_CLASSIFIER_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "DatFile.h"
+#include "DatDecompress.h"
+#include "TextureDecoder.h"
+#include "ThreadPool.h"
+
+// What an entry holds, told from its first bytes; one byte per entry
+enum class DatFileType : uint8_t {
+	Unclassified, // not scanned yet
+	Unknown,
+	Empty,
+	Unreadable,
+	Texture,      // ATEX, ATTX, ATEC, ATEP, ATEU, ATET
+	Dds,
+	Png,
+	Jpeg,
+	Model,        // PF MODL
+	Map,          // PF mapc
+	Material,     // PF AMAT
+	AudioPackFile, // PF ASND, ABNK, ABIX
+	PackFile,     // any other PF chunk file
+	Sound,        // asnd
+	Strings,      // strs
+	Ogg,
+	Mp3,
+	Wave,
+	Bink,
+	Executable,
+	Count
+};
+
+// Tags every MFT entry with a DatFileType in the background.
+//
+// Only the first SNIFF_SIZE bytes of an entry are looked at, fetched with DatFile::peekData,
+// which reads and inflates no further than that. Entries are walked in archive offset
+// order by one loop per pool thread taking BATCH_SIZE entries at a time, so the archive is
+// read front to back. Tags and per-type counts are atomics the UI thread can read while the
+// scan runs.
+class DatClassifier {
+public:
+	static constexpr size_t SNIFF_SIZE = 32;
+	static constexpr size_t BATCH_SIZE = 1024;
+
+	DatClassifier(DatFile& dat_file, size_t thread_count = 0) : dat_file(dat_file),
+		thread_count(thread_count), entry_count(dat_file.getMftData().size()), types(new std::atomic<uint8_t>[entry_count]),
+		classified_count(0), next_batch(0), cancelled(false) {
+		for (size_t i = 0; i < entry_count; ++i) {
+			types[i].store(static_cast<uint8_t>(DatFileType::Unclassified), std::memory_order_relaxed);
+		}
+		for (auto& count : type_counts) {
+			count.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	~DatClassifier() {
+		cancelled = true;
+		wait();
+	}
+
+	DatClassifier(const DatClassifier&) = delete;
+	DatClassifier& operator=(const DatClassifier&) = delete;
+
+	// Starts the scan and returns at once
+	void start() {
+		if (pool) {
+			return;
+		}
+		pool.reset(new ThreadPool(thread_count));
+		ThreadPool* workers = pool.get();
+		workers->submit([this, workers] {
+			planOrder();
+			for (size_t i = 0; i < workers->size(); ++i) {
+				workers->submit([this] { classifyBatches(); });
+			}
+		});
+	}
+
+	// Blocks until the scan has finished
+	void wait() {
+		if (pool) {
+			pool->wait();
+		}
+	}
+
+	void cancel() {
+		cancelled = true;
+	}
+
+	bool finished() const {
+		return classified_count.load() == entry_count;
+	}
+
+	size_t getClassifiedCount() const {
+		return classified_count.load();
+	}
+
+	size_t getEntryCount() const {
+		return entry_count;
+	}
+
+	DatFileType getType(uint32_t mft_index) const {
+		return static_cast<DatFileType>(types[mft_index].load(std::memory_order_relaxed));
+	}
+
+	// Entries tagged type so far
+	size_t getTypeCount(DatFileType type) const {
+		return type_counts[static_cast<size_t>(type)].load(std::memory_order_relaxed);
+	}
+
+	// Tags an entry from data the caller already decoded, e.g. the one being previewed
+	void classifyData(uint32_t mft_index, const uint8_t* data, size_t size) {
+		if (getType(mft_index) == DatFileType::Unclassified) {
+			store(mft_index, size == 0 ? DatFileType::Empty : sniff(data, size));
+		}
+	}
+
+	// Type of an entry starting with data, of which size bytes are available
+	static DatFileType sniff(const uint8_t* data, size_t size) {
+		auto startsWith = [&](const char* magic, size_t length) {
+			return size >= length && std::memcmp(data, magic, length) == 0;
+		};
+
+		if (TextureDecoder::isTexture(data, size)) {
+			return DatFileType::Texture;
+		}
+		if (startsWith("PF", 2)) {
+			// 12-byte header: "PF", version, zero, header size, then the file type
+			if (size < 12) {
+				return DatFileType::PackFile;
+			}
+			const uint8_t* kind = data + 8;
+			auto isKind = [&](const char* magic) { return std::memcmp(kind, magic, 4) == 0; };
+			if (isKind("MODL")) return DatFileType::Model;
+			if (isKind("mapc")) return DatFileType::Map;
+			if (isKind("AMAT")) return DatFileType::Material;
+			if (isKind("ASND") || isKind("ABNK") || isKind("ABIX")) return DatFileType::AudioPackFile;
+			return DatFileType::PackFile;
+		}
+		if (startsWith("asnd", 4)) return DatFileType::Sound;
+		if (startsWith("strs", 4)) return DatFileType::Strings;
+		if (startsWith("DDS ", 4)) return DatFileType::Dds;
+		if (startsWith("\x89PNG", 4)) return DatFileType::Png;
+		if (startsWith("\xFF\xD8\xFF", 3)) return DatFileType::Jpeg;
+		if (startsWith("OggS", 4)) return DatFileType::Ogg;
+		// Only tagged MP3s: a bare frame sync is too weak a signal to tell audio from random bytes
+		if (startsWith("ID3", 3)) return DatFileType::Mp3;
+		if (startsWith("RIFF", 4) && size >= 12 && std::memcmp(data + 8, "WAVE", 4) == 0) return DatFileType::Wave;
+		if (startsWith("BIK", 3) || startsWith("KB2", 3)) return DatFileType::Bink;
+		if (startsWith("MZ", 2)) return DatFileType::Executable;
+		return DatFileType::Unknown;
+	}
+
+	static const char* typeName(DatFileType type) {
+		switch (type) {
+		case DatFileType::Unclassified: return "Unclassified";
+		case DatFileType::Unknown: return "Unknown";
+		case DatFileType::Empty: return "Empty";
+		case DatFileType::Unreadable: return "Unreadable";
+		case DatFileType::Texture: return "Texture";
+		case DatFileType::Dds: return "DDS";
+		case DatFileType::Png: return "PNG";
+		case DatFileType::Jpeg: return "JPEG";
+		case DatFileType::Model: return "Model";
+		case DatFileType::Map: return "Map";
+		case DatFileType::Material: return "Material";
+		case DatFileType::AudioPackFile: return "Audio pack";
+		case DatFileType::PackFile: return "Pack file";
+		case DatFileType::Sound: return "Sound (asnd)";
+		case DatFileType::Strings: return "Strings";
+		case DatFileType::Ogg: return "OGG";
+		case DatFileType::Mp3: return "MP3";
+		case DatFileType::Wave: return "WAV";
+		case DatFileType::Bink: return "Bink video";
+		case DatFileType::Executable: return "Executable";
+		default: return "?";
+		}
+	}
+
+private:
+	DatFile& dat_file;
+	size_t thread_count;
+	size_t entry_count;
+	std::unique_ptr<std::atomic<uint8_t>[]> types;
+	std::atomic<size_t> type_counts[static_cast<size_t>(DatFileType::Count)];
+	std::atomic<size_t> classified_count;
+	std::vector<uint32_t> order;
+	std::atomic<size_t> next_batch;
+	std::atomic<bool> cancelled;
+	std::unique_ptr<ThreadPool> pool;
+
+	void planOrder() {
+		const auto& mft_data = dat_file.getMftData();
+		order.resize(entry_count);
+		for (uint32_t i = 0; i < entry_count; ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return mft_data[a].offset < mft_data[b].offset;
+		});
+	}
+
+	void classifyBatches() {
+		DatDecompressor decompressor;
+		size_t batch;
+		while (!cancelled && (batch = next_batch++) * BATCH_SIZE < order.size()) {
+			size_t end = std::min(order.size(), (batch + 1) * BATCH_SIZE);
+			for (size_t i = batch * BATCH_SIZE; i < end && !cancelled; ++i) {
+				classifyEntry(order[i], decompressor);
+			}
+		}
+	}
+
+	void classifyEntry(uint32_t mft_index, DatDecompressor& decompressor) {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+		if (entry.size == 0) {
+			store(mft_index, DatFileType::Empty);
+			return;
+		}
+
+		try {
+			uint8_t head[SNIFF_SIZE];
+			size_t head_size = dat_file.peekData(entry, head, SNIFF_SIZE, decompressor);
+			store(mft_index, head_size == 0 ? DatFileType::Empty : sniff(head, head_size));
+		}
+		catch (const std::exception&) {
+			store(mft_index, DatFileType::Unreadable);
+		}
+	}
+
+	void store(uint32_t mft_index, DatFileType type) {
+		uint8_t expected = static_cast<uint8_t>(DatFileType::Unclassified);
+		if (types[mft_index].compare_exchange_strong(expected, static_cast<uint8_t>(type))) {
+			type_counts[static_cast<size_t>(type)]++;
+			classified_count++;
+		}
+	}
+};
+
+#endif // !DAT_CLASSIFIER_H
@@ -0,0 +1,333 @@
+#ifndef DAT_COMPRESS_H
+#define DAT_COMPRESS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+#include "DatDecompress.h"
+
+// Encoder producing streams in the Gw2.dat compression format (see DatDecompress.h).
+// It exists to generate synthetic entries for benchmarks and test archives, so it favours
+// simplicity over ratio: greedy LZ matching with a short hash chain and one pair of trees
+// per block of codes. Output is a plain word stream without per-chunk CRC words.
+
+// Constants
+constexpr uint32_t DAT_MIN_MATCH_LENGTH = 4;
+constexpr uint32_t DAT_MAX_MATCH_LENGTH = DAT_MIN_MATCH_LENGTH + 0xFF;
+constexpr uint32_t DAT_MATCH_WINDOW = 0x10000;
+constexpr uint32_t DAT_BLOCK_CODE_COUNT = 0x10000;
+constexpr uint32_t DAT_MAX_ENCODED_BITS = 15;
+
+
+// MSB-first bit writer producing little-endian 32-bit words
+class DatBitWriter {
+public:
+	DatBitWriter() : bit_buffer(0), bit_count(0) {}
+
+	// bits must be in [0, 32]
+	void write(uint32_t value, uint32_t bits) {
+		if (bits == 0) {
+			return;
+		}
+		bit_buffer |= (static_cast<uint64_t>(value) & ((1ull << bits) - 1)) << (64 - bit_count - bits);
+		bit_count += bits;
+		while (bit_count >= 32) {
+			pushWord(static_cast<uint32_t>(bit_buffer >> 32));
+			bit_buffer <<= 32;
+			bit_count -= 32;
+		}
+	}
+
+	std::vector<uint8_t> finish() {
+		if (bit_count > 0) {
+			pushWord(static_cast<uint32_t>(bit_buffer >> 32));
+			bit_buffer = 0;
+			bit_count = 0;
+		}
+		return std::move(output);
+	}
+
+private:
+	std::vector<uint8_t> output;
+	uint64_t bit_buffer;
+	uint32_t bit_count;
+
+	void pushWord(uint32_t word) {
+		size_t position = output.size();
+		output.resize(position + 4);
+		std::memcpy(output.data() + position, &word, 4);
+	}
+};
+
+
+class DatCompressor {
+public:
+	std::vector<uint8_t> compress(const uint8_t* data, size_t size) {
+		std::vector<Token> tokens = findMatches(data, size);
+
+		DatBitWriter writer;
+		writer.write(0, 32);
+		writer.write(static_cast<uint32_t>(size), 32);
+		writer.write(0, 4);
+		writer.write(DAT_MIN_MATCH_LENGTH - 1, 4);
+
+		// Dictionary codes for the code length runs
+		uint8_t dictionary_lengths[DAT_LITERAL_COUNT];
+		uint32_t dictionary_codes[DAT_LITERAL_COUNT];
+		datDictionaryCodeLengths(dictionary_lengths);
+		datAssignCodes(dictionary_lengths, DAT_LITERAL_COUNT, dictionary_codes);
+
+		for (size_t block_start = 0; block_start < tokens.size(); block_start += DAT_BLOCK_CODE_COUNT) {
+			size_t block_end = std::min(tokens.size(), block_start + DAT_BLOCK_CODE_COUNT);
+
+			uint32_t symbol_frequencies[DAT_MAX_SYMBOL_VALUE] = {};
+			uint32_t copy_frequencies[DAT_COPY_OFFSET_CODES] = {};
+			for (size_t i = block_start; i < block_end; ++i) {
+				++symbol_frequencies[tokens[i].symbol];
+				if (tokens[i].symbol >= DAT_LITERAL_COUNT) {
+					++copy_frequencies[tokens[i].offset_code];
+				}
+			}
+			// The decoder treats an empty tree as the end of the stream
+			if (std::all_of(copy_frequencies, copy_frequencies + DAT_COPY_OFFSET_CODES,
+				[](uint32_t frequency) { return frequency == 0; })) {
+				copy_frequencies[0] = 1;
+			}
+
+			uint8_t symbol_lengths[DAT_MAX_SYMBOL_VALUE];
+			uint8_t copy_lengths[DAT_COPY_OFFSET_CODES];
+			uint32_t symbol_codes[DAT_MAX_SYMBOL_VALUE];
+			uint32_t copy_codes[DAT_COPY_OFFSET_CODES];
+			uint32_t symbol_count = buildCodeLengths(symbol_frequencies, DAT_MAX_SYMBOL_VALUE, symbol_lengths);
+			uint32_t copy_count = buildCodeLengths(copy_frequencies, DAT_COPY_OFFSET_CODES, copy_lengths);
+			datAssignCodes(symbol_lengths, symbol_count, symbol_codes);
+			datAssignCodes(copy_lengths, copy_count, copy_codes);
+
+			writeTree(writer, symbol_lengths, symbol_count, dictionary_lengths, dictionary_codes);
+			writeTree(writer, copy_lengths, copy_count, dictionary_lengths, dictionary_codes);
+
+			// Block code count in units of 4096; the final block may claim more than it holds
+			uint32_t count_field = static_cast<uint32_t>((block_end - block_start + 0xFFF) >> 12) - 1;
+			writer.write(count_field, 4);
+
+			for (size_t i = block_start; i < block_end; ++i) {
+				const Token& token = tokens[i];
+				writer.write(symbol_codes[token.symbol], symbol_lengths[token.symbol]);
+				if (token.symbol >= DAT_LITERAL_COUNT) {
+					writer.write(token.length_extra, token.length_extra_bits);
+					writer.write(copy_codes[token.offset_code], copy_lengths[token.offset_code]);
+					writer.write(token.offset_extra, token.offset_extra_bits);
+				}
+			}
+		}
+
+		return writer.finish();
+	}
+
+private:
+	struct Token {
+		uint16_t symbol;
+		uint8_t length_extra_bits;
+		uint8_t offset_code;
+		uint8_t offset_extra_bits;
+		uint32_t length_extra;
+		uint32_t offset_extra;
+	};
+
+	static std::vector<Token> findMatches(const uint8_t* data, size_t size) {
+		constexpr uint32_t hash_bits = 15;
+		constexpr uint32_t max_chain = 16;
+
+		std::vector<Token> tokens;
+		tokens.reserve(size / 2 + 1);
+		std::vector<int64_t> head(1u << hash_bits, -1);
+		std::vector<int64_t> previous(DAT_MATCH_WINDOW, -1);
+
+		auto hashAt = [&](size_t position) {
+			uint32_t value;
+			std::memcpy(&value, data + position, 4);
+			return (value * 2654435761u) >> (32 - hash_bits);
+		};
+		auto insert = [&](size_t position) {
+			if (position + DAT_MIN_MATCH_LENGTH <= size) {
+				uint32_t hash = hashAt(position);
+				previous[position % DAT_MATCH_WINDOW] = head[hash];
+				head[hash] = static_cast<int64_t>(position);
+			}
+		};
+
+		size_t position = 0;
+		while (position < size) {
+			size_t best_length = 0;
+			size_t best_offset = 0;
+
+			if (position + DAT_MIN_MATCH_LENGTH <= size) {
+				size_t max_length = std::min(static_cast<size_t>(DAT_MAX_MATCH_LENGTH), size - position);
+				int64_t candidate = head[hashAt(position)];
+				for (uint32_t chain = 0; chain < max_chain && candidate >= 0; ++chain) {
+					size_t offset = position - static_cast<size_t>(candidate);
+					if (offset >= DAT_MATCH_WINDOW) {
+						break;
+					}
+					size_t length = 0;
+					while (length < max_length && data[candidate + length] == data[position + length]) {
+						++length;
+					}
+					if (length > best_length) {
+						best_length = length;
+						best_offset = offset;
+					}
+					candidate = previous[candidate % DAT_MATCH_WINDOW];
+				}
+			}
+
+			if (best_length >= DAT_MIN_MATCH_LENGTH) {
+				tokens.push_back(makeCopy(static_cast<uint32_t>(best_length), static_cast<uint32_t>(best_offset)));
+				for (size_t i = 0; i < best_length; ++i) {
+					insert(position + i);
+				}
+				position += best_length;
+			}
+			else {
+				Token literal = {};
+				literal.symbol = data[position];
+				tokens.push_back(literal);
+				insert(position);
+				++position;
+			}
+		}
+
+		return tokens;
+	}
+
+	static uint32_t floorLog2(uint32_t value) {
+		uint32_t result = 0;
+		while (value >>= 1) {
+			++result;
+		}
+		return result;
+	}
+
+	// Inverse of DatDecompressor::decodeCopyLength and decodeCopyOffset
+	static Token makeCopy(uint32_t length, uint32_t offset) {
+		Token token = {};
+
+		uint32_t length_value = length - DAT_MIN_MATCH_LENGTH;
+		if (length_value < 8) {
+			token.symbol = static_cast<uint16_t>(DAT_LITERAL_COUNT + length_value);
+		}
+		else {
+			uint32_t quotient = floorLog2(length_value) - 1;
+			uint32_t extra_bits = quotient - 1;
+			token.symbol = static_cast<uint16_t>(DAT_LITERAL_COUNT + quotient * 4 + ((length_value >> extra_bits) - 4));
+			token.length_extra_bits = static_cast<uint8_t>(extra_bits);
+			token.length_extra = length_value & ((1u << extra_bits) - 1);
+		}
+
+		uint32_t offset_value = offset - 1;
+		if (offset_value < 4) {
+			token.offset_code = static_cast<uint8_t>(offset_value);
+		}
+		else {
+			uint32_t quotient = floorLog2(offset_value);
+			uint32_t extra_bits = quotient - 1;
+			token.offset_code = static_cast<uint8_t>(quotient * 2 + ((offset_value >> extra_bits) - 2));
+			token.offset_extra_bits = static_cast<uint8_t>(extra_bits);
+			token.offset_extra = offset_value & ((1u << extra_bits) - 1);
+		}
+
+		return token;
+	}
+
+	// Huffman code lengths limited to DAT_MAX_ENCODED_BITS; returns the tree's symbol count
+	static uint32_t buildCodeLengths(const uint32_t* frequencies, uint32_t symbol_count, uint8_t* code_lengths) {
+		std::fill(code_lengths, code_lengths + symbol_count, static_cast<uint8_t>(0));
+
+		std::vector<uint32_t> weights(frequencies, frequencies + symbol_count);
+		uint32_t used_symbols = 0;
+		uint32_t last_symbol = 0;
+		for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+			if (weights[symbol] != 0) {
+				++used_symbols;
+				last_symbol = symbol;
+			}
+		}
+		if (used_symbols == 1) {
+			code_lengths[last_symbol] = 1;
+			return last_symbol + 1;
+		}
+
+		while (true) {
+			// Nodes: leaves first, then internal nodes; parents track depth
+			typedef std::pair<uint64_t, uint32_t> Node;
+			std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+			std::vector<uint32_t> parents(symbol_count * 2, 0);
+			for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+				if (weights[symbol] != 0) {
+					queue.push(Node(weights[symbol], symbol));
+				}
+			}
+
+			uint32_t next_node = symbol_count;
+			while (queue.size() > 1) {
+				Node first = queue.top();
+				queue.pop();
+				Node second = queue.top();
+				queue.pop();
+				parents[first.second] = next_node;
+				parents[second.second] = next_node;
+				queue.push(Node(first.first + second.first, next_node));
+				++next_node;
+			}
+
+			uint32_t root = next_node - 1;
+			uint32_t max_length = 0;
+			for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+				if (weights[symbol] == 0) {
+					continue;
+				}
+				uint32_t length = 0;
+				for (uint32_t node = symbol; node != root; node = parents[node]) {
+					++length;
+				}
+				code_lengths[symbol] = static_cast<uint8_t>(length);
+				max_length = std::max(max_length, length);
+			}
+
+			if (max_length <= DAT_MAX_ENCODED_BITS) {
+				return last_symbol + 1;
+			}
+
+			// Flatten the distribution and retry until the tree is shallow enough
+			for (auto& weight : weights) {
+				if (weight != 0) {
+					weight = (weight >> 1) | 1;
+				}
+			}
+		}
+	}
+
+	static void writeTree(DatBitWriter& writer, const uint8_t* code_lengths, uint32_t symbol_count,
+		const uint8_t* dictionary_lengths, const uint32_t* dictionary_codes) {
+		writer.write(symbol_count, 16);
+
+		// Runs of up to 8 equal lengths, from the last symbol down to the first
+		int32_t symbol = static_cast<int32_t>(symbol_count) - 1;
+		while (symbol >= 0) {
+			uint8_t bits = code_lengths[symbol];
+			uint32_t run = 1;
+			while (run < 8 && symbol - static_cast<int32_t>(run) >= 0 && code_lengths[symbol - run] == bits) {
+				++run;
+			}
+			uint32_t code = bits | ((run - 1) << 5);
+			writer.write(dictionary_codes[code], dictionary_lengths[code]);
+			symbol -= static_cast<int32_t>(run);
+		}
+	}
+};
+
+#endif // !DAT_COMPRESS_H
@@ -0,0 +1,612 @@
+#ifndef DAT_DECOMPRESS_H
+#define DAT_DECOMPRESS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+
+// Decoder for the Huffman/LZ compression used by Gw2.dat entries.
+//
+// Bit fields are read MSB-first from little-endian 32-bit words. Raw entries carry a CRC word
+// at the end of every 64 KiB chunk, which the reader skips when decoding in chunked mode.
+//
+// Stream layout:
+//   32 bits  unknown header
+//   32 bits  uncompressed size
+//    4 bits  unknown
+//    4 bits  copy length bias - 1
+//   blocks until the output is full:
+//     symbol tree (literals 0-255, copy length codes 256-284)
+//     copy tree   (copy offset codes 0-33)
+//      4 bits     block code count, stored as (count >> 12) - 1
+//     codes
+//
+// Trees are stored as a 16-bit symbol count followed by run-length encoded code lengths,
+// themselves Huffman coded with a fixed dictionary tree.
+
+// Constants
+constexpr uint32_t DAT_MAX_SYMBOL_VALUE = 285;
+constexpr uint32_t DAT_MAX_CODE_BITS = 32;
+constexpr uint32_t DAT_LOOKUP_BITS = 10;
+constexpr uint32_t DAT_LOOKUP_SIZE = 1 << DAT_LOOKUP_BITS;
+constexpr uint32_t DAT_CRC_WORD_INTERVAL = 0x4000;
+constexpr uint32_t DAT_LITERAL_COUNT = 0x100;
+constexpr uint32_t DAT_COPY_LENGTH_CODES = 29;
+constexpr uint32_t DAT_COPY_OFFSET_CODES = 34;
+
+
+// Canonical code assignment shared by the decoder tables and the synthetic stream encoder.
+// Codes are handed out per bit length in ascending order, starting from the all-ones code and
+// counting down, with lower symbols receiving higher codes. Returns false if the lengths
+// oversubscribe the code space or no symbol is used.
+inline bool datAssignCodes(const uint8_t* code_lengths, uint32_t symbol_count, uint32_t* codes) {
+	uint32_t length_counts[DAT_MAX_CODE_BITS] = {};
+	for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+		if (code_lengths[symbol] >= DAT_MAX_CODE_BITS) {
+			return false;
+		}
+		++length_counts[code_lengths[symbol]];
+	}
+
+	uint32_t next_code[DAT_MAX_CODE_BITS] = {};
+	uint64_t code = 0;
+	bool has_symbols = false;
+	for (uint32_t bits = 1; bits < DAT_MAX_CODE_BITS; ++bits) {
+		code = (code << 1) + 1;
+		next_code[bits] = static_cast<uint32_t>(code);
+		if (length_counts[bits] > code + 1) {
+			return false;
+		}
+		code -= length_counts[bits];
+		has_symbols |= length_counts[bits] != 0;
+	}
+
+	for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+		uint8_t bits = code_lengths[symbol];
+		codes[symbol] = bits ? next_code[bits]-- : 0;
+	}
+
+	return has_symbols;
+}
+
+// Code lengths of the fixed tree used to decode the code length runs of every block tree
+inline void datDictionaryCodeLengths(uint8_t* code_lengths) {
+	static const uint8_t dictionary[][2] = {
+		{ 0x0A, 3 }, { 0x09, 3 }, { 0x08, 3 },
+		{ 0x0C, 4 }, { 0x0B, 4 }, { 0x07, 4 }, { 0x00, 4 },
+		{ 0xE0, 5 }, { 0x2A, 5 }, { 0x29, 5 }, { 0x06, 5 },
+		{ 0x4A, 6 }, { 0x40, 6 }, { 0x2C, 6 }, { 0x2B, 6 }, { 0x28, 6 }, { 0x20, 6 }, { 0x05, 6 }, { 0x04, 6 },
+		{ 0x49, 7 }, { 0x48, 7 }, { 0x27, 7 }, { 0x26, 7 }, { 0x25, 7 }, { 0x0D, 7 }, { 0x03, 7 },
+		{ 0x6A, 8 }, { 0x69, 8 }, { 0x4C, 8 }, { 0x4B, 8 }, { 0x47, 8 }, { 0x24, 8 },
+		{ 0xE8, 9 }, { 0xA0, 9 }, { 0x89, 9 }, { 0x88, 9 }, { 0x68, 9 }, { 0x67, 9 }, { 0x63, 9 }, { 0x60, 9 },
+		{ 0x46, 9 }, { 0x23, 9 },
+		{ 0xE9, 10 }, { 0xC9, 10 }, { 0xC0, 10 }, { 0xA9, 10 }, { 0xA8, 10 }, { 0x8A, 10 }, { 0x87, 10 },
+		{ 0x80, 10 }, { 0x66, 10 }, { 0x65, 10 }, { 0x45, 10 }, { 0x44, 10 }, { 0x43, 10 }, { 0x2D, 10 },
+		{ 0x02, 10 }, { 0x01, 10 },
+		{ 0xE5, 11 }, { 0xC8, 11 }, { 0xAA, 11 }, { 0xA5, 11 }, { 0xA4, 11 }, { 0x8B, 11 }, { 0x85, 11 },
+		{ 0x84, 11 }, { 0x6C, 11 }, { 0x6B, 11 }, { 0x64, 11 }, { 0x4D, 11 }, { 0x0E, 11 },
+		{ 0xE7, 12 }, { 0xCA, 12 }, { 0xC7, 12 }, { 0xA7, 12 }, { 0xA6, 12 }, { 0x86, 12 }, { 0x83, 12 },
+		{ 0xE6, 13 }, { 0xE4, 13 }, { 0xC4, 13 }, { 0x8C, 13 }, { 0x2E, 13 }, { 0x22, 13 },
+		{ 0xEC, 14 }, { 0xC6, 14 }, { 0x6D, 14 }, { 0x4E, 14 },
+		{ 0xEA, 15 }, { 0xCC, 15 }, { 0xAC, 15 }, { 0xAB, 15 }, { 0x8D, 15 }, { 0x11, 15 }, { 0x10, 15 },
+		{ 0x0F, 15 },
+	};
+
+	// Every remaining byte value gets a 16-bit code
+	std::fill(code_lengths, code_lengths + DAT_LITERAL_COUNT, static_cast<uint8_t>(16));
+	for (const auto& entry : dictionary) {
+		code_lengths[entry[0]] = entry[1];
+	}
+}
+
+
+// Supplies a compressed stream block by block, so it can be decoded without holding it whole
+class DatInputSource {
+public:
+	virtual ~DatInputSource() {}
+
+	// Points data at the next block and returns its size, 0 at the end of the stream.
+	// Every block but the last must be a multiple of 4 bytes.
+	virtual size_t next(const uint8_t*& data) = 0;
+};
+
+// MSB-first bit reader over little-endian 32-bit words
+class DatBitReader {
+public:
+	// Everything needed to carry on reading from the same bit, for decoder checkpoints
+	struct Position {
+		uint64_t word_position = 0;     // next word to load, CRC words included
+		uint64_t crc_word_position = 0;
+		uint64_t bit_buffer = 0;
+		uint32_t bit_count = 0;
+	};
+
+	DatBitReader(const uint8_t* input, size_t input_size, bool chunked)
+		: input_data(input), input_size(input_size), input_base(0), source(nullptr), word_position(0),
+		crc_word_position(chunked ? DAT_CRC_WORD_INTERVAL - 1 : SIZE_MAX),
+		bit_buffer(0), bit_count(0), overrun_words(0) {
+		refill();
+		refill();
+	}
+
+	// Pulls the input from source as it is consumed. CRC words are still skipped by their
+	// position in the whole stream, whatever the block sizes.
+	DatBitReader(DatInputSource& source, bool chunked)
+		: input_data(nullptr), input_size(0), input_base(0), source(&source), word_position(0),
+		crc_word_position(chunked ? DAT_CRC_WORD_INTERVAL - 1 : SIZE_MAX),
+		bit_buffer(0), bit_count(0), overrun_words(0) {
+		refill();
+		refill();
+	}
+
+	// Carries on from position over the whole stream in input
+	DatBitReader(const uint8_t* input, size_t input_size, const Position& position)
+		: input_data(input), input_size(input_size), input_base(0), source(nullptr),
+		word_position(static_cast<size_t>(position.word_position)), crc_word_position(static_cast<size_t>(position.crc_word_position)),
+		bit_buffer(position.bit_buffer), bit_count(position.bit_count), overrun_words(0) {
+	}
+
+	Position getPosition() const {
+		Position position;
+		position.word_position = word_position;
+		position.crc_word_position = crc_word_position;
+		position.bit_buffer = bit_buffer;
+		position.bit_count = bit_count;
+		return position;
+	}
+
+	// Guarantees at least 33 buffered bits, provided at most 32 bits were consumed since the last refill
+	void refill() {
+		if (bit_count <= 32) {
+			bit_buffer |= static_cast<uint64_t>(nextWord()) << (32 - bit_count);
+			bit_count += 32;
+		}
+	}
+
+	// Top bits of the buffer; bits must be in [1, 32] and already buffered
+	uint32_t peek(uint32_t bits) const {
+		return static_cast<uint32_t>(bit_buffer >> (64 - bits));
+	}
+
+	void consume(uint32_t bits) {
+		bit_buffer <<= bits;
+		bit_count -= bits;
+	}
+
+	uint32_t read(uint32_t bits) {
+		refill();
+		uint32_t value = peek(bits);
+		consume(bits);
+		return value;
+	}
+
+	uint32_t head() const {
+		return static_cast<uint32_t>(bit_buffer >> 32);
+	}
+
+private:
+	const uint8_t* input_data;
+	size_t input_size;
+	size_t input_base; // stream position of input_data[0]
+	DatInputSource* source;
+	size_t word_position;
+	size_t crc_word_position;
+	uint64_t bit_buffer;
+	uint32_t bit_count;
+	uint32_t overrun_words;
+
+	uint32_t nextWord() {
+		// The last word of every 64 KiB chunk is a CRC, not payload
+		if (word_position == crc_word_position) {
+			++word_position;
+			crc_word_position += DAT_CRC_WORD_INTERVAL;
+		}
+
+		size_t byte_position = word_position * 4 - input_base;
+		++word_position;
+
+		// Blocks hold whole words, so a word never straddles two of them
+		while (byte_position >= input_size && source) {
+			input_base += input_size;
+			byte_position -= input_size;
+			input_size = source->next(input_data);
+			if (input_size == 0) {
+				source = nullptr;
+			}
+		}
+
+		uint32_t word = 0;
+		if (byte_position + 4 <= input_size) {
+			std::memcpy(&word, input_data + byte_position, 4);
+		}
+		else if (byte_position < input_size) {
+			std::memcpy(&word, input_data + byte_position, input_size - byte_position);
+		}
+		else if (++overrun_words > 4) {
+			// The refill look-ahead may run a few words past the end, decoding may not
+			throw std::runtime_error("Compressed stream ended unexpectedly");
+		}
+		return word;
+	}
+};
+
+
+// Decoding tables for one Huffman tree.
+// Codes up to DAT_LOOKUP_BITS long resolve with a single table lookup; when built for the
+// symbol tree, an entry whose bits also fully contain a second literal code decodes both
+// literals at once. Longer codes fall back to a per-length canonical range search.
+class DatHuffmanTable {
+public:
+	struct LookupEntry {
+		uint16_t symbol;
+		uint8_t length;      // 0 when the code is longer than DAT_LOOKUP_BITS
+		uint8_t pair_length; // bits of symbol + pair_symbol, 0 when no second literal fits
+		uint8_t pair_symbol;
+	};
+
+	LookupEntry lookup[DAT_LOOKUP_SIZE];
+
+	bool build(const uint8_t* code_lengths, uint32_t symbol_count, bool pair_literals) {
+		uint32_t codes[DAT_MAX_SYMBOL_VALUE];
+		if (symbol_count > DAT_MAX_SYMBOL_VALUE || !datAssignCodes(code_lengths, symbol_count, codes)) {
+			return false;
+		}
+
+		std::memset(lookup, 0, sizeof(lookup));
+		long_code_count = 0;
+
+		// Bucket symbols by length, keeping ascending symbol order inside each length
+		uint16_t sorted_symbols[DAT_MAX_SYMBOL_VALUE];
+		uint32_t length_offsets[DAT_MAX_CODE_BITS + 1] = {};
+		for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+			++length_offsets[code_lengths[symbol] + 1];
+		}
+		for (uint32_t bits = 1; bits <= DAT_MAX_CODE_BITS; ++bits) {
+			length_offsets[bits] += length_offsets[bits - 1];
+		}
+		uint32_t fill_positions[DAT_MAX_CODE_BITS];
+		std::memcpy(fill_positions, length_offsets, sizeof(fill_positions));
+		for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+			sorted_symbols[fill_positions[code_lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+		}
+
+		uint16_t long_symbol_count = 0;
+		for (uint32_t bits = 1; bits < DAT_MAX_CODE_BITS; ++bits) {
+			uint32_t first = length_offsets[bits];
+			uint32_t last = length_offsets[bits + 1];
+			if (first == last) {
+				continue;
+			}
+
+			if (bits <= DAT_LOOKUP_BITS) {
+				uint32_t span = 1u << (DAT_LOOKUP_BITS - bits);
+				for (uint32_t i = first; i < last; ++i) {
+					uint16_t symbol = sorted_symbols[i];
+					LookupEntry* entry = lookup + (codes[symbol] << (DAT_LOOKUP_BITS - bits));
+					for (uint32_t j = 0; j < span; ++j) {
+						entry[j].symbol = symbol;
+						entry[j].length = static_cast<uint8_t>(bits);
+					}
+				}
+				continue;
+			}
+
+			// Ascending symbols carry descending codes, so the last one holds the range minimum
+			long_symbol_first[long_code_count] = long_symbol_count;
+			for (uint32_t i = first; i < last; ++i) {
+				long_symbols[long_symbol_count++] = sorted_symbols[i];
+			}
+			long_symbol_last[long_code_count] = static_cast<uint16_t>(long_symbol_count - 1);
+			long_code_min[long_code_count] = codes[sorted_symbols[last - 1]] << (32 - bits);
+			long_code_bits[long_code_count] = static_cast<uint8_t>(bits);
+			++long_code_count;
+		}
+
+		if (pair_literals) {
+			for (uint32_t i = 0; i < DAT_LOOKUP_SIZE; ++i) {
+				LookupEntry& entry = lookup[i];
+				if (entry.length == 0 || entry.length >= DAT_LOOKUP_BITS || entry.symbol >= DAT_LITERAL_COUNT) {
+					continue;
+				}
+				const LookupEntry& next = lookup[(i << entry.length) & (DAT_LOOKUP_SIZE - 1)];
+				if (next.length != 0 && next.symbol < DAT_LITERAL_COUNT &&
+					entry.length + next.length <= DAT_LOOKUP_BITS) {
+					entry.pair_length = static_cast<uint8_t>(entry.length + next.length);
+					entry.pair_symbol = static_cast<uint8_t>(next.symbol);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Resolves a code missing from the lookup table; the reader must be refilled
+	uint16_t decodeLong(DatBitReader& reader) const {
+		uint32_t head = reader.head();
+		uint32_t index = 0;
+		while (index < long_code_count && head < long_code_min[index]) {
+			++index;
+		}
+		if (index == long_code_count) {
+			throw std::runtime_error("Invalid Huffman code in compressed stream");
+		}
+
+		uint32_t bits = long_code_bits[index];
+		uint32_t delta = (head - long_code_min[index]) >> (32 - bits);
+		if (delta > static_cast<uint32_t>(long_symbol_last[index] - long_symbol_first[index])) {
+			throw std::runtime_error("Invalid Huffman code in compressed stream");
+		}
+
+		reader.consume(bits);
+		return long_symbols[long_symbol_last[index] - delta];
+	}
+
+	uint16_t decode(DatBitReader& reader) const {
+		reader.refill();
+		const LookupEntry& entry = lookup[reader.peek(DAT_LOOKUP_BITS)];
+		if (entry.length != 0) {
+			reader.consume(entry.length);
+			return entry.symbol;
+		}
+		return decodeLong(reader);
+	}
+
+private:
+	uint32_t long_code_min[DAT_MAX_CODE_BITS];
+	uint8_t long_code_bits[DAT_MAX_CODE_BITS];
+	uint16_t long_symbol_first[DAT_MAX_CODE_BITS];
+	uint16_t long_symbol_last[DAT_MAX_CODE_BITS];
+	uint32_t long_code_count = 0;
+	uint16_t long_symbols[DAT_MAX_SYMBOL_VALUE];
+};
+
+
+class DatDecompressor {
+public:
+	// Where decoding stopped, so a stream can be decoded into a bounded buffer piece by piece
+	struct State {
+		uint64_t remaining_output = 0; // bytes still to produce
+		uint32_t copy_length_bias = 0;
+		uint32_t block_remaining = 0;  // codes left in the current block, 0 before its trees
+		uint32_t pending_copy_offset = 0;
+		size_t pending_copy_length = 0; // rest of a copy that did not fit the last output range
+		bool finished = false;
+		DatBitReader::Position tree_position; // of the current block's trees, see restoreTrees
+	};
+
+	// Uncompressed size stored in the stream header, 0 if the input is too short to hold one
+	static uint32_t readUncompressedSize(const uint8_t* input, size_t input_size) {
+		uint32_t size = 0;
+		if (input_size >= 8) {
+			std::memcpy(&size, input + 4, sizeof(size));
+		}
+		return size;
+	}
+
+	// Decodes into output and returns the number of bytes written, which is the smaller of
+	// output_size and the stream's uncompressed size unless the stream ends early.
+	// chunked selects raw archive entries that still carry their per-chunk CRC words.
+	size_t inflate(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size, bool chunked = true) {
+		DatBitReader reader(input, input_size, chunked);
+		State state = begin(reader);
+		state.remaining_output = std::min<uint64_t>(state.remaining_output, output_size);
+		return static_cast<size_t>(decode(reader, state, output, output, output + output_size) - output);
+	}
+
+	// Reads the stream header; the returned state is then passed to every decode call
+	static State begin(DatBitReader& reader) {
+		State state;
+
+		// Skipping the header and reading the uncompressed size
+		reader.read(32);
+		state.remaining_output = reader.read(32);
+
+		// Constant added to every copy length
+		reader.read(4);
+		state.copy_length_bias = reader.read(4) + 1;
+		return state;
+	}
+
+	// Decodes into [out, out_end) and returns the end of the bytes written. Copies may reach
+	// back to history_begin, so a caller decoding in pieces keeps the last 128 KiB of output in
+	// front of out. Sets state.finished once the whole stream has been produced.
+	uint8_t* decode(DatBitReader& reader, State& state, const uint8_t* history_begin, uint8_t* out, uint8_t* out_end) {
+		if (state.remaining_output < static_cast<uint64_t>(out_end - out)) {
+			out_end = out + state.remaining_output;
+		}
+		uint8_t* const out_start = out;
+
+		// Finish a copy cut short by the previous range
+		if (state.pending_copy_length != 0) {
+			size_t length = std::min(state.pending_copy_length, static_cast<size_t>(out_end - out));
+			copyMatch(out, state.pending_copy_offset, length);
+			out += length;
+			state.pending_copy_length -= length;
+		}
+
+		uint32_t block_remaining = state.block_remaining;
+		while (out < out_end) {
+			if (block_remaining == 0) {
+				state.tree_position = reader.getPosition();
+				if (!readTree(reader, symbol_table, true) || !readTree(reader, copy_table, false)) {
+					state.remaining_output = 0;
+					break;
+				}
+				block_remaining = (reader.read(4) + 1) << 12;
+			}
+
+			while (block_remaining != 0 && out < out_end) {
+				reader.refill();
+				const DatHuffmanTable::LookupEntry& entry = symbol_table.lookup[reader.peek(DAT_LOOKUP_BITS)];
+
+				// Two literals in one lookup
+				if (entry.pair_length != 0 && block_remaining >= 2 && out_end - out >= 2) {
+					out[0] = static_cast<uint8_t>(entry.symbol);
+					out[1] = entry.pair_symbol;
+					out += 2;
+					block_remaining -= 2;
+					reader.consume(entry.pair_length);
+					continue;
+				}
+
+				--block_remaining;
+				uint32_t symbol;
+				if (entry.length != 0) {
+					reader.consume(entry.length);
+					symbol = entry.symbol;
+				}
+				else {
+					symbol = symbol_table.decodeLong(reader);
+				}
+
+				if (symbol < DAT_LITERAL_COUNT) {
+					*out++ = static_cast<uint8_t>(symbol);
+					continue;
+				}
+
+				uint32_t copy_length = decodeCopyLength(reader, symbol - DAT_LITERAL_COUNT) + state.copy_length_bias;
+				uint32_t copy_offset = decodeCopyOffset(reader, copy_table.decode(reader));
+
+				if (copy_offset > static_cast<size_t>(out - history_begin)) {
+					throw std::runtime_error("Invalid copy offset in compressed stream");
+				}
+
+				size_t length = std::min(static_cast<size_t>(copy_length), static_cast<size_t>(out_end - out));
+				copyMatch(out, copy_offset, length);
+				out += length;
+				if (length < copy_length) {
+					state.pending_copy_offset = copy_offset;
+					state.pending_copy_length = copy_length - length;
+				}
+			}
+		}
+		state.block_remaining = block_remaining;
+
+		state.remaining_output -= std::min<uint64_t>(state.remaining_output, static_cast<uint64_t>(out - out_start));
+		if (state.remaining_output == 0) {
+			state.pending_copy_length = 0;
+			state.finished = true;
+		}
+		return out;
+	}
+
+	// Rebuilds the current block's tables from a reader at state.tree_position, so a State saved
+	// mid-block can be decoded from by a fresh decompressor
+	void restoreTrees(DatBitReader& reader) {
+		if (!readTree(reader, symbol_table, true) || !readTree(reader, copy_table, false)) {
+			throw std::runtime_error("Checkpoint does not point at a block");
+		}
+	}
+
+private:
+	DatHuffmanTable symbol_table;
+	DatHuffmanTable copy_table;
+
+	static const DatHuffmanTable& dictionaryTable() {
+		static const DatHuffmanTable table = [] {
+			DatHuffmanTable dictionary;
+			uint8_t code_lengths[DAT_LITERAL_COUNT];
+			datDictionaryCodeLengths(code_lengths);
+			dictionary.build(code_lengths, DAT_LITERAL_COUNT, false);
+			return dictionary;
+		}();
+		return table;
+	}
+
+	static bool readTree(DatBitReader& reader, DatHuffmanTable& table, bool pair_literals) {
+		uint32_t symbol_count = reader.read(16);
+		if (symbol_count > DAT_MAX_SYMBOL_VALUE) {
+			throw std::runtime_error("Too many symbols in compressed stream tree");
+		}
+
+		uint8_t code_lengths[DAT_MAX_SYMBOL_VALUE] = {};
+		const DatHuffmanTable& dictionary = dictionaryTable();
+
+		// Runs of code lengths, from the last symbol down to the first
+		int32_t remaining = static_cast<int32_t>(symbol_count) - 1;
+		while (remaining >= 0) {
+			uint16_t code = dictionary.decode(reader);
+			uint8_t bits = code & 0x1F;
+			int32_t run = (code >> 5) + 1;
+
+			if (bits != 0) {
+				if (run > remaining + 1) {
+					throw std::runtime_error("Invalid code length run in compressed stream tree");
+				}
+				std::fill(code_lengths + remaining - run + 1, code_lengths + remaining + 1, bits);
+			}
+			remaining -= run;
+		}
+
+		if (!table.build(code_lengths, symbol_count, pair_literals)) {
+			// An empty tree ends the stream, an oversubscribed one is corrupt
+			for (uint32_t symbol = 0; symbol < symbol_count; ++symbol) {
+				if (code_lengths[symbol] != 0) {
+					throw std::runtime_error("Invalid Huffman tree in compressed stream");
+				}
+			}
+			return false;
+		}
+		return true;
+	}
+
+	static uint32_t decodeCopyLength(DatBitReader& reader, uint32_t code) {
+		if (code >= DAT_COPY_LENGTH_CODES) {
+			throw std::runtime_error("Invalid copy length code in compressed stream");
+		}
+		if (code == 28) {
+			return 0xFF;
+		}
+
+		uint32_t quotient = code / 4;
+		uint32_t remainder = code % 4;
+		if (quotient == 0) {
+			return code;
+		}
+
+		uint32_t length = (1u << (quotient - 1)) * (4 + remainder);
+		if (quotient > 1) {
+			length |= reader.read(quotient - 1);
+		}
+		return length;
+	}
+
+	static uint32_t decodeCopyOffset(DatBitReader& reader, uint32_t code) {
+		if (code >= DAT_COPY_OFFSET_CODES) {
+			throw std::runtime_error("Invalid copy offset code in compressed stream");
+		}
+
+		uint32_t quotient = code / 2;
+		uint32_t remainder = code % 2;
+		if (quotient == 0) {
+			return code + 1;
+		}
+
+		uint32_t offset = (1u << (quotient - 1)) * (2 + remainder);
+		if (quotient > 1) {
+			offset |= reader.read(quotient - 1);
+		}
+		return offset + 1;
+	}
+
+	static void copyMatch(uint8_t* out, size_t offset, size_t length) {
+		const uint8_t* source = out - offset;
+		if (offset >= length) {
+			std::memcpy(out, source, length);
+		}
+		else if (offset == 1) {
+			std::memset(out, *source, length);
+		}
+		else {
+			// Overlapping copy repeats the last offset bytes
+			for (size_t i = 0; i < length; ++i) {
+				out[i] = source[i];
+			}
+		}
+	}
+};
+
+#endif // !DAT_DECOMPRESS_H
@@ -0,0 +1,233 @@
+#ifndef DAT_ENTRY_STREAM_H
+#define DAT_ENTRY_STREAM_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "DatFile.h"
+#include "DatDecompress.h"
+
+// Pull-based reader over one MFT entry that never holds the whole entry in memory.
+//
+// next() hands out the entry piece by piece: raw archive bytes, the payload with the chunk CRC
+// words stripped, or the inflated data of compressed entries. Inflating keeps the last
+// WINDOW_SIZE bytes of output in front of each new block, the farthest a copy can reach back,
+// and slides them down once the buffer is full. A stream holds about 320 KiB whatever the size
+// of the entry. In Mapped mode the input is read straight from the mapping; in Stream mode it
+// is read one archive chunk at a time through read, which defaults to DatFile::readRaw.
+class DatEntryStream {
+public:
+	// Copies length bytes at archive offset into buffer; throws on failure
+	typedef std::function<void(uint64_t offset, uint8_t* buffer, size_t length)> ReadFunction;
+
+	static constexpr size_t WINDOW_SIZE = 128 * 1024;
+	static constexpr size_t BLOCK_SIZE = 128 * 1024;
+
+	// decompress false yields the raw entry, CRC words included
+	DatEntryStream(DatFile& dat_file, const DatFile::MftData& entry, bool decompress = true, ReadFunction read = nullptr)
+		: entry_offset(entry.offset), entry_size(entry.size), raw_position(0), output_position(0), output_end(0),
+		position(0), pending(), source(*this) {
+		if (dat_file.isMapped()) {
+			mapped_span = dat_file.getEntrySpan(entry);
+		}
+		else {
+			read_function = read ? std::move(read) : [&dat_file](uint64_t offset, uint8_t* buffer, size_t length) {
+				dat_file.readRaw(offset, buffer, length);
+			};
+			input.resize(CHUNK_SIZE);
+		}
+
+		if (!decompress) {
+			mode = Mode::Raw;
+			size = entry_size;
+		}
+		else if (entry.compression_flag == 0) {
+			mode = Mode::Payload;
+			size = DatFile::payloadSize(entry_size);
+		}
+		else {
+			mode = Mode::Inflate;
+			reader.reset(new DatBitReader(source, true));
+			state = DatDecompressor::begin(*reader);
+			size = state.remaining_output;
+			output.resize(WINDOW_SIZE + BLOCK_SIZE);
+		}
+	}
+
+	DatEntryStream(const DatEntryStream&) = delete;
+	DatEntryStream& operator=(const DatEntryStream&) = delete;
+
+	// Next piece of the entry, valid until the following call; empty at the end
+	ByteSpan next() {
+		ByteSpan span;
+		if (pending.size != 0) {
+			span = pending;
+			pending = ByteSpan();
+		}
+		else {
+			switch (mode) {
+			case Mode::Raw: span = nextRaw(); break;
+			case Mode::Payload: span = nextPayload(); break;
+			case Mode::Inflate: span = nextInflated(); break;
+			}
+		}
+		position += span.size;
+		return span;
+	}
+
+	// Copies up to length bytes into buffer and returns how many were copied, 0 at the end
+	size_t read(uint8_t* buffer, size_t length) {
+		size_t copied = 0;
+		while (copied < length) {
+			ByteSpan span = next();
+			if (span.empty()) {
+				break;
+			}
+			size_t count = std::min(span.size, length - copied);
+			std::memcpy(buffer + copied, span.data, count);
+			copied += count;
+
+			// Hand the rest back out first on the next call
+			if (count < span.size) {
+				pending = span.subspan(count, span.size - count);
+				position -= pending.size;
+			}
+		}
+		return copied;
+	}
+
+	// Bytes the stream yields in total; for compressed entries the size in the stream header,
+	// which a damaged stream may fall short of
+	uint64_t getSize() const {
+		return size;
+	}
+
+	// Bytes handed out so far
+	uint64_t getPosition() const {
+		return position;
+	}
+
+	bool atEnd() const {
+		if (pending.size != 0) {
+			return false;
+		}
+		if (mode == Mode::Inflate) {
+			return state.finished && output_position == output_end;
+		}
+		return raw_position >= entry_size;
+	}
+
+private:
+	enum class Mode {
+		Raw,
+		Payload,
+		Inflate
+	};
+
+	// Feeds the bit reader whole archive chunks, which are multiples of 4 bytes
+	class Source : public DatInputSource {
+	public:
+		explicit Source(DatEntryStream& stream) : stream(stream) {}
+
+		size_t next(const uint8_t*& data) override {
+			ByteSpan span = stream.nextRaw();
+			data = span.data;
+			return span.size;
+		}
+
+	private:
+		DatEntryStream& stream;
+	};
+
+	uint64_t entry_offset;
+	uint64_t entry_size;
+	uint64_t raw_position;
+	ByteSpan mapped_span;
+	ReadFunction read_function; // unset in Mapped mode
+	std::vector<uint8_t> input;
+	Mode mode;
+	uint64_t size;
+
+	DatDecompressor decompressor;
+	DatDecompressor::State state;
+	std::unique_ptr<DatBitReader> reader;
+	std::vector<uint8_t> output;
+	size_t output_position; // start of the bytes not handed out yet
+	size_t output_end;
+
+	uint64_t position;
+	ByteSpan pending;
+	Source source;
+
+	// Whole entry at once from the mapping, otherwise the next archive chunk
+	ByteSpan nextRaw() {
+		if (raw_position >= entry_size) {
+			return ByteSpan();
+		}
+		if (!read_function) {
+			raw_position = entry_size;
+			return mapped_span;
+		}
+
+		size_t length = static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, entry_size - raw_position));
+		read_function(entry_offset + raw_position, input.data(), length);
+		raw_position += length;
+		return ByteSpan(input.data(), length);
+	}
+
+	// One chunk's payload without its CRC word
+	ByteSpan nextPayload() {
+		if (entry_size <= 4) {
+			return nextRaw();
+		}
+
+		while (raw_position < entry_size) {
+			size_t length = static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, entry_size - raw_position));
+			ByteSpan chunk;
+			if (!read_function) {
+				chunk = mapped_span.subspan(static_cast<size_t>(raw_position), length);
+				raw_position += length;
+			}
+			else {
+				read_function(entry_offset + raw_position, input.data(), length);
+				raw_position += length;
+				chunk = ByteSpan(input.data(), length);
+			}
+
+			// A trailing piece shorter than a CRC word carries no payload
+			if (chunk.size > 4) {
+				return chunk.subspan(0, chunk.size - 4);
+			}
+		}
+		return ByteSpan();
+	}
+
+	ByteSpan nextInflated() {
+		if (output_position == output_end) {
+			if (state.finished) {
+				return ByteSpan();
+			}
+
+			// Keep the copy window in front of the next block
+			if (output_end == output.size()) {
+				std::memmove(output.data(), output.data() + output_end - WINDOW_SIZE, WINDOW_SIZE);
+				output_end = WINDOW_SIZE;
+			}
+
+			uint8_t* out = output.data() + output_end;
+			uint8_t* end = decompressor.decode(*reader, state, output.data(), out, output.data() + output.size());
+			output_position = output_end;
+			output_end = static_cast<size_t>(end - output.data());
+		}
+
+		ByteSpan span(output.data() + output_position, output_end - output_position);
+		output_position = output_end;
+		return span;
+	}
+};
+
+#endif // !DAT_ENTRY_STREAM_H
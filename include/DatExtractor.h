@@ -0,0 +1,267 @@
+#ifndef DAT_EXTRACTOR_H
+#define DAT_EXTRACTOR_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "DatFile.h"
+#include "DatEntryStream.h"
+#include "ThreadPool.h"
+
+// Headless bulk extraction of every MFT entry.
+//
+// Entries are scheduled in archive offset order so reads stay sequential, then read,
+// decompressed and written on a work-stealing thread pool. Each entry is streamed to disk
+// through a DatEntryStream, so it costs the same fixed buffers whatever its size, and the
+// buffers of queued and running entries are capped by a memory budget. Finished entries are
+// appended to a journal in the output directory, so an interrupted run can resume where it
+// stopped.
+class DatExtractor {
+public:
+	struct Options {
+		std::string output_directory = "extracted";
+		size_t thread_count = 0;              // 0 = one per hardware thread
+		uint64_t memory_budget = 512ull << 20; // stream buffers of queued and running entries
+		bool decompress = true;
+		bool resume = true;                    // skip entries recorded in the journal
+	};
+
+	struct Progress {
+		uint64_t entries_total = 0;
+		std::atomic<uint64_t> entries_done{ 0 };
+		std::atomic<uint64_t> entries_skipped{ 0 };
+		std::atomic<uint64_t> entries_failed{ 0 };
+		std::atomic<uint64_t> bytes_read{ 0 };
+		std::atomic<uint64_t> bytes_written{ 0 };
+	};
+
+	struct Failure {
+		uint32_t mft_index;
+		std::string message;
+	};
+
+	typedef std::function<void(const Progress&)> ProgressCallback;
+
+	DatExtractor(DatFile& dat_file, const Options& options) : dat_file(dat_file), options(options),
+		in_flight_bytes(0), cancelled(false) {
+	}
+
+	// Extracts all entries, calling callback from this thread roughly every progress_interval
+	void run(const ProgressCallback& callback = nullptr,
+		std::chrono::milliseconds progress_interval = std::chrono::milliseconds(250)) {
+		createDirectory(options.output_directory);
+
+		const auto& mft_data = dat_file.getMftData();
+		std::vector<bool> completed = options.resume ? loadJournal(mft_data.size()) : std::vector<bool>(mft_data.size(), false);
+		journal.open(journalPath(), options.resume ? std::ios::app : std::ios::trunc);
+		if (!journal) {
+			throw std::runtime_error("Failed to open extraction journal: " + journalPath());
+		}
+
+		// Sequential archive order
+		std::vector<uint32_t> order;
+		order.reserve(mft_data.size());
+		for (uint32_t i = 0; i < mft_data.size(); ++i) {
+			if (mft_data[i].size != 0) {
+				order.push_back(i);
+			}
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return mft_data[a].offset < mft_data[b].offset;
+		});
+
+		progress.entries_total = order.size();
+		auto last_report = std::chrono::steady_clock::now();
+		auto report = [&](bool force) {
+			auto now = std::chrono::steady_clock::now();
+			if (callback && (force || now - last_report >= progress_interval)) {
+				callback(progress);
+				last_report = now;
+			}
+		};
+
+		ThreadPool pool(options.thread_count);
+		for (uint32_t index : order) {
+			if (cancelled) {
+				break;
+			}
+			if (completed[index]) {
+				progress.entries_skipped++;
+				continue;
+			}
+
+			uint64_t charge = STREAM_MEMORY;
+			acquireBudget(charge, report);
+			pool.submit([this, index, charge] {
+				extractEntry(index);
+				releaseBudget(charge);
+			});
+			report(false);
+		}
+
+		// Keep reporting while the pool drains
+		while (true) {
+			std::unique_lock<std::mutex> lock(budget_mutex);
+			if (budget_condition.wait_for(lock, progress_interval, [this] { return in_flight_bytes == 0; })) {
+				break;
+			}
+			lock.unlock();
+			report(false);
+		}
+		pool.wait();
+
+		journal.flush();
+		journal.close();
+		report(true);
+	}
+
+	// Stops scheduling new entries; entries already queued still finish
+	void cancel() {
+		cancelled = true;
+	}
+
+	const Progress& getProgress() const {
+		return progress;
+	}
+
+	const std::vector<Failure>& getFailures() const {
+		return failures;
+	}
+
+	// Output path used for an entry, matching the viewer's single-entry export names
+	std::string entryPath(uint32_t mft_index) const {
+		return options.output_directory + "/" + (options.decompress ? "decompressed_" : "compressed_") +
+			std::to_string(mft_index) + ".bin";
+	}
+
+private:
+	DatFile& dat_file;
+	Options options;
+	Progress progress;
+	std::vector<Failure> failures;
+	std::mutex failure_mutex;
+	std::mutex journal_mutex;
+	std::ofstream journal;
+	uint64_t journal_pending = 0;
+	std::mutex budget_mutex;
+	std::condition_variable budget_condition;
+	uint64_t in_flight_bytes;
+	std::atomic<bool> cancelled;
+
+	std::string journalPath() const {
+		return options.output_directory + "/extract.journal";
+	}
+
+	static void createDirectory(const std::string& path) {
+#ifdef _WIN32
+		int result = _mkdir(path.c_str());
+#else
+		int result = mkdir(path.c_str(), 0755);
+#endif
+		if (result != 0 && errno != EEXIST) {
+			throw std::runtime_error("Failed to create output directory: " + path);
+		}
+	}
+
+	std::vector<bool> loadJournal(size_t entry_count) const {
+		std::vector<bool> completed(entry_count, false);
+		std::ifstream input(journalPath());
+		uint64_t index;
+		while (input >> index) {
+			if (index < entry_count) {
+				completed[index] = true;
+			}
+		}
+		return completed;
+	}
+
+	void recordCompleted(uint32_t mft_index) {
+		std::lock_guard<std::mutex> lock(journal_mutex);
+		journal << mft_index << '\n';
+		if (++journal_pending >= 256) {
+			journal.flush();
+			journal_pending = 0;
+		}
+	}
+
+	// Input chunk plus inflate window of one DatEntryStream
+	static constexpr uint64_t STREAM_MEMORY = CHUNK_SIZE + DatEntryStream::WINDOW_SIZE + DatEntryStream::BLOCK_SIZE;
+
+	template <typename Report>
+	void acquireBudget(uint64_t charge, Report& report) {
+		std::unique_lock<std::mutex> lock(budget_mutex);
+		// Caps the streams in flight at budget / STREAM_MEMORY; one always runs, even when the
+		// budget is smaller than a single stream
+		while (in_flight_bytes != 0 && in_flight_bytes + charge > options.memory_budget) {
+			budget_condition.wait_for(lock, std::chrono::milliseconds(50));
+			lock.unlock();
+			report(false);
+			lock.lock();
+		}
+		in_flight_bytes += charge;
+	}
+
+	void releaseBudget(uint64_t charge) {
+		{
+			std::lock_guard<std::mutex> lock(budget_mutex);
+			in_flight_bytes -= charge;
+		}
+		budget_condition.notify_all();
+	}
+
+	void extractEntry(uint32_t mft_index) {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+
+		try {
+			DatEntryStream stream(dat_file, entry, options.decompress);
+
+			// Write under a temporary name so a crash never leaves a truncated entry behind
+			std::string path = entryPath(mft_index);
+			std::string temporary_path = path + ".part";
+			uint64_t written = 0;
+			{
+				std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+				for (ByteSpan span = stream.next(); !span.empty() && output; span = stream.next()) {
+					output.write(reinterpret_cast<const char*>(span.data), span.size);
+					written += span.size;
+				}
+				output.close();
+				if (!output) {
+					throw std::runtime_error("Failed to write file: " + temporary_path);
+				}
+			}
+			progress.bytes_read += entry.size;
+			std::remove(path.c_str());
+			if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+				throw std::runtime_error("Failed to rename " + temporary_path + " to " + path);
+			}
+
+			progress.bytes_written += written;
+			progress.entries_done++;
+			recordCompleted(mft_index);
+		}
+		catch (const std::exception& e) {
+			progress.entries_failed++;
+			std::lock_guard<std::mutex> lock(failure_mutex);
+			failures.push_back({ mft_index, e.what() });
+		}
+	}
+};
+
+#endif // !DAT_EXTRACTOR_H
@@ -1,4 +1,5 @@
 #ifndef DAT_FILE_H
+#define DAT_FILE_H
 
 #include <iostream>
 #include <fstream>
@@ -8,7 +9,15 @@
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
-
+#include <memory>
+
+#include "MappedFile.h"
+#include "PositionalFile.h"
+#include "UringReader.h"
+#include "DatDecompress.h"
+#include "Crc32c.h"
+#include "DatSearchIndex.h"
+#include "DatCache.h"
 // Constants
 constexpr size_t DAT_MAGIC_NUMBER = 3;
 constexpr size_t MFT_MAGIC_NUMBER = 4;
@@ -17,6 +26,15 @@ constexpr size_t CHUNK_SIZE = 0x10000;
 constexpr size_t START_INDEX = CHUNK_SIZE - 4;
 constexpr size_t END_INDEX = CHUNK_SIZE;
 
+// On-disk record sizes, all fields little endian and unpadded
+constexpr size_t DAT_HEADER_SIZE = 40;
+constexpr size_t MFT_HEADER_SIZE = 24;
+constexpr size_t MFT_ENTRY_SIZE = 24;
+constexpr size_t MFT_INDEX_ENTRY_SIZE = 8;
+
+// First read of a peek in Stream mode; later reads double up to a chunk
+constexpr size_t PEEK_INPUT_SIZE = 4096;
+
 
 
 class DatFile {
@@ -74,8 +92,16 @@ public:
 		MftIndexData() : file_id(0), base_id(0) {}
 	};
 
-	// Constructor
-	DatFile(const std::string& file_path) : filename(file_path), file_size(0) {
+	// How entry bytes are fetched from the archive. Both are safe to read from any number of
+	// threads at once; the tables themselves are only changed by the update* methods.
+	enum class ReadMode {
+		Stream, // positional reads (pread / overlapped ReadFile) into caller buffers
+		Mapped  // zero-copy views over a memory mapping of the whole archive
+	};
+
+	// Constructor; with use_cache the parsed tables are kept in a sidecar file (see DatCache)
+	DatFile(const std::string& file_path, ReadMode mode = ReadMode::Mapped, bool use_cache = true) : filename(file_path),
+		file_size(0), read_mode(mode), use_cache(use_cache) {
 		load();
 	}
 
@@ -83,12 +109,50 @@ public:
 	void load() {
 		validateFileExtension();
 		openFile();
+		mapFile();
 		readDatHeader();
+
+		loaded_from_cache = use_cache && readCache();
+		if (loaded_from_cache) {
+			return;
+		}
+
 		readMftHeader();
 		readMftData();
 		readMftIndexData();
 	}
 
+	// Stores the raw tables and the fully built search index for the next start, when load()
+	// could not use a cache. Building the index is the slow part, so the viewer calls this after
+	// its first frame, on a thread of its own: it builds a separate search index and only reads
+	// the tables, which load() leaves unchanged, so other threads keep using this DatFile.
+	// Failures only cost the next start.
+	bool writeCache() const {
+		if (!use_cache || loaded_from_cache) {
+			return true;
+		}
+		std::string cache_path = DatCache::pathFor(filename);
+		if (!DatCache::canWrite(cache_path)) {
+			return false;
+		}
+
+		size_t table_size = static_cast<size_t>(mft_header.mft_entry_size) * MFT_ENTRY_SIZE;
+		std::vector<uint8_t> storage(MFT_HEADER_SIZE + table_size);
+		readAt(dat_header.mft_offset, storage.data(), storage.size());
+		ByteSpan mft_block(storage.data(), storage.size());
+
+		DatSearchIndex cache_index;
+		cache_index.build(mft_index_data);
+		std::vector<uint8_t> search_index_data = cache_index.serialize();
+
+		DatCache::Sections sections;
+		sections.mft_header = mft_block.subspan(0, MFT_HEADER_SIZE);
+		sections.mft_table = mft_block.subspan(MFT_HEADER_SIZE, table_size);
+		sections.index_table = ByteSpan(reinterpret_cast<const uint8_t*>(mft_index_data.data()), mft_index_data.size() * MFT_INDEX_ENTRY_SIZE);
+		sections.search_index = ByteSpan(search_index_data.data(), search_index_data.size());
+		return DatCache::write(cache_path, cacheKey(), sections);
+	}
+
 	void printSummary() const {
 		// Print DAT file header summary
 		std::cout << "DAT File: " << filename << "\n"
@@ -127,118 +191,308 @@ public:
 		return mft_data;
 	}
 
+	// True when the MFT tables and search index came from the sidecar cache (see DatCache)
+	bool isLoadedFromCache() const {
+		return loaded_from_cache;
+	}
+
+	// Identifies this version of the archive, for sidecar files that must go stale with it
+	DatCache::Key cacheKey() const {
+		DatCache::Key key;
+		key.header_crc = dat_header.crc;
+		key.mft_offset = dat_header.mft_offset;
+		key.file_size = file_size;
+		key.modification_time = DatCache::modificationTime(filename);
+		return key;
+	}
+
+	// Mode actually in use; Mapped falls back to Stream when the archive cannot be mapped
+	ReadMode getReadMode() const {
+		return read_mode;
+	}
+
+	bool isMapped() const {
+		return read_mode == ReadMode::Mapped;
+	}
+
+	// Zero-copy view of an entry's raw (compressed, CRC-chunked) bytes; only valid in Mapped mode
+	ByteSpan getEntrySpan(const MftData& entry) const {
+		if (!isMapped()) {
+			throw std::logic_error("Entry spans require a memory-mapped DAT file: " + filename);
+		}
+		return getEntrySpanAt(entry.offset, entry.size);
+	}
+
 	// Function to read compressed data
 	std::vector<uint8_t> readCompressedData(const MftData& entry) {
 		std::vector<uint8_t> compressed_data(entry.size);
+		readAt(entry.offset, compressed_data.data(), entry.size);
+		return compressed_data;
+	}
+
+	// Copies raw archive bytes, for views over the whole file rather than one entry
+	void readRaw(uint64_t offset, void* dst, size_t size) {
+		readAt(offset, dst, size);
+	}
+
+	// Bytes [offset, offset + size) of the archive: a view into the mapping, or read into storage
+	ByteSpan readBlock(uint64_t offset, size_t size, std::vector<uint8_t>& storage) {
+		if (isMapped()) {
+			mapped_file.willNeed(offset, size);
+			return getEntrySpanAt(offset, size);
+		}
+		storage.resize(size);
+		readAt(offset, storage.data(), size);
+		return ByteSpan(storage.data(), size);
+	}
 
-		// Seek to the specified offset
-		file.seekg(entry.offset);
-		if (!file) {
-			throw std::runtime_error("Failed to seek to offset: " + std::to_string(entry.offset) +
-				" in file: " + filename);
+	// io_uring reader for whole-archive scans in Stream mode; null when the archive is mapped or
+	// io_uring is unavailable, the caller then reads entry by entry
+	std::unique_ptr<UringReader> createUringReader(size_t buffer_count, size_t buffer_size) const {
+		if (isMapped()) {
+			return nullptr;
+		}
+		try {
+			return std::unique_ptr<UringReader>(new UringReader(file, buffer_count, buffer_size));
+		}
+		catch (const std::exception&) {
+			return nullptr;
 		}
+	}
 
+	// Paged search for MFT entries whose base_id (or file_id) contains data_id as a decimal substring
+	DatSearchIndex::Results searchMftData(uint32_t data_id, bool is_base_id) {
+		return getSearchIndex().find(data_id, is_base_id ? DatSearchIndex::Key::BaseId : DatSearchIndex::Key::FileId);
+	}
 
-		// Read data into the buffer
-		file.read(reinterpret_cast<char*>(compressed_data.data()), entry.size);
+	std::vector<uint32_t> findMftData(uint32_t data_id, bool is_base_id) {
+		return searchMftData(data_id, is_base_id).all();
+	}
 
-		// Check if the read was successful
-		if (file.gcount() != entry.size) {
-			throw std::runtime_error("Failed to read the full size from file: " + filename + " in offset: " + std::to_string(entry.offset));
+	// MFT entries whose base_id (or file_id) is exactly data_id
+	std::vector<uint32_t> findMftDataExact(uint32_t data_id, bool is_base_id) {
+		return getSearchIndex().findExact(data_id, is_base_id ? DatSearchIndex::Key::BaseId : DatSearchIndex::Key::FileId);
+	}
+
+
+	// Function to read compressed data with the chunk CRC words stripped.
+	// With verify_crc set, every chunk's CRC32C word is checked and a mismatch throws.
+	std::vector<uint8_t> removeCrc32Data(const MftData& entry, bool verify_crc = false) {
+		std::vector<uint8_t> compressed_data(entry.size);
+		size_t payload_size;
+
+		if (isMapped()) {
+			payload_size = removeCrc32Words(getEntrySpan(entry), compressed_data.data(), verify_crc);
+		}
+		else {
+			// Compact in place, the payload never overtakes the bytes still to be read
+			readAt(entry.offset, compressed_data.data(), entry.size);
+			payload_size = removeCrc32Words(ByteSpan(compressed_data.data(), compressed_data.size()),
+				compressed_data.data(), verify_crc);
 		}
 
+		compressed_data.resize(payload_size);
 		return compressed_data;
 	}
 
-	std::vector<uint32_t> findMftData(uint32_t data_id, bool is_base_id) {
-		std::set<uint32_t> data_found; // Use std::set to maintain sorted order
-
-		// Length of the number to find
-		uint32_t divisor = 1;
-		uint32_t temp = data_id;
-		while (temp > 0) {
-			divisor *= 10;
-			temp /= 10;
-		}
-
-		// Search for the number
-		for (uint32_t i = 0; i < mft_index_data.size(); i++) {
-			if (is_base_id) {
-				uint32_t num = mft_index_data[i].base_id;
-				while (num >= data_id) { // Only check if num is large enough
-					if (num % divisor == data_id) { // Match the substring
-						data_found.insert(mft_index_data[i].base_id);
-						break;
-					}
-					num /= 10; // Remove the last digit
-				}
+	// Walks the chunks of a raw entry: every full chunk ends in a CRC word, and so does a
+	// trailing partial chunk. Entries of 4 bytes or less carry no CRC word.
+	// visit(payload, crc_offset, stored_crc) receives each chunk's payload and CRC position.
+	template <typename Visitor>
+	static void forEachChunk(ByteSpan raw_data, Visitor visit) {
+		if (raw_data.size <= 4) {
+			visit(raw_data, raw_data.size, 0u);
+			return;
+		}
+
+		for (size_t position = 0; position < raw_data.size; position += CHUNK_SIZE) {
+			size_t chunk_size = std::min(static_cast<size_t>(CHUNK_SIZE), raw_data.size - position);
+			if (chunk_size < 4) {
+				break;
 			}
-			else {
-				uint32_t num = mft_index_data[i].file_id;
-				while (num >= data_id) { // Only check if num is large enough
-					if (num % divisor == data_id) { // Match the substring
-						data_found.insert(mft_index_data[i].base_id);
-						break;
-					}
-					num /= 10; // Remove the last digit
-				}
+
+			size_t crc_offset = position + chunk_size - 4;
+			uint32_t stored_crc;
+			std::memcpy(&stored_crc, raw_data.data + crc_offset, sizeof(stored_crc));
+			visit(raw_data.subspan(position, chunk_size - 4), crc_offset, stored_crc);
+		}
+	}
+
+	// Payload bytes of a raw entry, matching forEachChunk
+	static uint64_t payloadSize(uint64_t raw_size) {
+		if (raw_size <= 4) {
+			return raw_size;
+		}
+		uint64_t tail = raw_size % CHUNK_SIZE;
+		return raw_size - raw_size / CHUNK_SIZE * 4 - (tail >= 4 ? 4 : tail);
+	}
+
+	// Scatter list of an entry's payload, excluding the CRC words
+	static std::vector<ByteSpan> payloadSpans(ByteSpan raw_data) {
+		std::vector<ByteSpan> spans;
+		spans.reserve(raw_data.size / CHUNK_SIZE + 1);
+		forEachChunk(raw_data, [&](ByteSpan payload, size_t, uint32_t) {
+			if (!payload.empty()) {
+				spans.push_back(payload);
 			}
+		});
+		return spans;
+	}
+
+	// Copies the payload of raw_data into output in one pass and returns its size.
+	// output may alias raw_data.data for in-place stripping.
+	static size_t removeCrc32Words(ByteSpan raw_data, uint8_t* output, bool verify_crc = false) {
+		size_t written = 0;
+		size_t chunk_index = 0;
+		forEachChunk(raw_data, [&](ByteSpan payload, size_t crc_offset, uint32_t stored_crc) {
+			if (verify_crc && crc_offset < raw_data.size && Crc32c::compute(payload.data, payload.size) != stored_crc) {
+				throw std::runtime_error("CRC32C mismatch in chunk " + std::to_string(chunk_index) +
+					" at entry offset " + std::to_string(crc_offset));
+			}
+			if (payload.size != 0) {
+				std::memmove(output + written, payload.data, payload.size);
+			}
+			written += payload.size;
+			++chunk_index;
+		});
+		return written;
+	}
+
+	// Index of the first chunk whose CRC32C word does not match its payload, or -1 when all match
+	static int64_t findCorruptChunk(ByteSpan raw_data) {
+		int64_t chunk_index = 0;
+		int64_t corrupt_chunk = -1;
+		forEachChunk(raw_data, [&](ByteSpan payload, size_t crc_offset, uint32_t stored_crc) {
+			if (corrupt_chunk < 0 && crc_offset < raw_data.size && Crc32c::compute(payload.data, payload.size) != stored_crc) {
+				corrupt_chunk = chunk_index;
+			}
+			++chunk_index;
+		});
+		return corrupt_chunk;
+	}
+
+	// Stored CRC words of an entry's chunks, 4 bytes each in chunk order, after checking every one
+	// against its payload; a mismatch throws. Nothing is copied in Mapped mode.
+	std::vector<uint8_t> verifyChunkCrcs(const MftData& entry) {
+		std::vector<uint8_t> raw_data;
+		ByteSpan raw_span;
+		if (isMapped()) {
+			raw_span = getEntrySpan(entry);
+		}
+		else {
+			raw_data = readCompressedData(entry);
+			raw_span = ByteSpan(raw_data.data(), raw_data.size());
 		}
 
-		return std::vector<uint32_t>(data_found.begin(), data_found.end());
+		std::vector<uint8_t> crc_words;
+		size_t chunk_index = 0;
+		forEachChunk(raw_span, [&](ByteSpan payload, size_t crc_offset, uint32_t stored_crc) {
+			if (crc_offset >= raw_span.size) {
+				return;
+			}
+			if (Crc32c::compute(payload.data, payload.size) != stored_crc) {
+				throw std::runtime_error("CRC32C mismatch in chunk " + std::to_string(chunk_index) +
+					" at entry offset " + std::to_string(crc_offset));
+			}
+			const uint8_t* word = raw_span.data + crc_offset;
+			crc_words.insert(crc_words.end(), word, word + 4);
+			++chunk_index;
+		});
+		return crc_words;
 	}
 
+	// Fills crc_32c_data from the words returned by verifyChunkCrcs
+	void setCrc32cData(uint64_t index_data, const std::vector<uint8_t>& crc_words) {
+		MftData& entry = mft_data[index_data];
+		entry.crc_32c_data.clear();
+		for (size_t chunk = 0; chunk < crc_words.size() / 4; ++chunk) {
+			uint64_t chunk_end = std::min<uint64_t>((chunk + 1) * CHUNK_SIZE, entry.size);
+			uint32_t stored_crc;
+			std::memcpy(&stored_crc, crc_words.data() + chunk * 4, sizeof(stored_crc));
+			entry.crc_32c_data.emplace_back(chunk_end - 4, stored_crc);
+		}
+	}
 
-	// Function to read compressed data
-	std::vector<uint8_t> removeCrc32Data(const MftData& entry) {
-		std::vector<uint8_t> compressed_data(entry.size);
+	// Reads an entry and inflates it when compressed; uncompressed entries only lose their CRC words
+	std::vector<uint8_t> readDecompressedData(const MftData& entry) {
+		if (entry.compression_flag == 0) {
+			return removeCrc32Data(entry);
+		}
 
-		// Seek to the specified offset
-		file.seekg(entry.offset);
-		if (!file) {
-			throw std::runtime_error("Failed to seek to offset: " + std::to_string(entry.offset) +
-				" in file: " + filename);
+		// Decode straight from the mapping when possible, the decoder skips the CRC words itself
+		std::vector<uint8_t> raw_data;
+		ByteSpan input;
+		if (isMapped()) {
+			input = getEntrySpan(entry);
+		}
+		else {
+			raw_data = readCompressedData(entry);
+			input = ByteSpan(raw_data.data(), raw_data.size());
 		}
 
+		return inflateEntryData(input);
+	}
 
-		// Read data into the buffer
-		file.read(reinterpret_cast<char*>(compressed_data.data()), entry.size);
+	// Inflates raw compressed entry bytes, CRC words included
+	static std::vector<uint8_t> inflateEntryData(ByteSpan input) {
+		std::vector<uint8_t> decompressed_data(DatDecompressor::readUncompressedSize(input.data, input.size));
+		DatDecompressor decompressor;
+		decompressed_data.resize(decompressor.inflate(input.data, input.size, decompressed_data.data(), decompressed_data.size()));
+		return decompressed_data;
+	}
 
-		// Check if the read was successful
-		if (file.gcount() != entry.size) {
-			throw std::runtime_error("Failed to read the full size from file: " + filename + " in offset: " + std::to_string(entry.offset));
+	// Size of the entry once decompressed, read from its compression header; raw size for uncompressed entries
+	uint32_t readUncompressedSize(const MftData& entry) {
+		if (entry.compression_flag == 0 || entry.size < 8) {
+			return entry.size;
 		}
 
-		if (entry.size > CHUNK_SIZE)
-		{
-			uint64_t position = 0;
-			while (position + CHUNK_SIZE <= compressed_data.size())
-			{
-				compressed_data.erase(compressed_data.begin() + position + START_INDEX, compressed_data.begin() + position + END_INDEX);
-				position += CHUNK_SIZE - 4;
-			}
+		uint8_t header[8];
+		readAt(entry.offset, header, sizeof(header));
+		return DatDecompressor::readUncompressedSize(header, sizeof(header));
+	}
 
-			if (compressed_data.size() > 4)
-			{
-				compressed_data.erase(compressed_data.end() - 4, compressed_data.end());
+	// The first size bytes of the entry's decompressed data, fewer if it is shorter. Only the
+	// chunks holding them are read and inflation stops once they exist, so a header costs a few
+	// KiB of reads whatever the size of the entry.
+	std::vector<uint8_t> peekData(const MftData& entry, size_t size) {
+		std::vector<uint8_t> data(size);
+		DatDecompressor decompressor;
+		data.resize(peekData(entry, data.data(), size, decompressor));
+		return data;
+	}
 
-			}
+	// As above into output, reusing the caller's decompressor; returns the bytes written
+	size_t peekData(const MftData& entry, uint8_t* output, size_t size, DatDecompressor& decompressor) {
+		if (size == 0 || entry.size == 0) {
+			return 0;
+		}
 
+		if (entry.compression_flag != 0) {
+			PeekSource source(*this, entry);
+			DatBitReader reader(source, true);
+			DatDecompressor::State state = DatDecompressor::begin(reader);
+			return static_cast<size_t>(decompressor.decode(reader, state, output, output, output + size) - output);
 		}
-		else if (entry.size == CHUNK_SIZE)
-		{
-			compressed_data.erase(compressed_data.begin() + START_INDEX, compressed_data.begin() + END_INDEX);
 
+		if (entry.size <= 4) {
+			size_t length = std::min<size_t>(size, entry.size);
+			readAt(entry.offset, output, length);
+			return length;
 		}
-		else if (entry.size < CHUNK_SIZE) {
-			if (compressed_data.size() > 4)
-			{
-				compressed_data.erase(compressed_data.end() - 4, compressed_data.end());
 
+		// Same chunk walk as forEachChunk, reading only the payload bytes asked for
+		size_t written = 0;
+		for (uint64_t chunk_start = 0; written < size && chunk_start < entry.size; chunk_start += CHUNK_SIZE) {
+			uint64_t chunk_size = std::min<uint64_t>(CHUNK_SIZE, entry.size - chunk_start);
+			if (chunk_size < 4) {
+				break;
 			}
+			size_t length = static_cast<size_t>(std::min<uint64_t>(size - written, chunk_size - 4));
+			readAt(entry.offset + chunk_start, output + written, length);
+			written += length;
 		}
-
-		return compressed_data;
+		return written;
 	}
 
 	void updateUncompressedSize(uint64_t index_data, uint32_t decompressed_size) {
@@ -254,7 +508,48 @@ private:
 	MftHeader mft_header;
 	std::vector<MftData> mft_data;
 	std::vector<MftIndexData> mft_index_data;
-	std::ifstream file;
+	PositionalFile file;
+	ReadMode read_mode;
+	MappedFile mapped_file;
+	DatSearchIndex search_index;
+	bool search_index_built = false;
+	bool use_cache;
+	bool loaded_from_cache = false;
+
+	// Feeds a peek's bit reader: the whole span when mapped, otherwise reads that start at
+	// PEEK_INPUT_SIZE and double, so short peeks stay short and long ones take few calls
+	class PeekSource : public DatInputSource {
+	public:
+		PeekSource(DatFile& dat_file, const MftData& entry) : dat_file(dat_file), entry(entry), position(0),
+			block_size(PEEK_INPUT_SIZE) {}
+
+		size_t next(const uint8_t*& data) override {
+			if (position >= entry.size) {
+				return 0;
+			}
+			if (dat_file.isMapped()) {
+				ByteSpan span = dat_file.getEntrySpan(entry);
+				position = entry.size;
+				data = span.data;
+				return span.size;
+			}
+
+			size_t length = static_cast<size_t>(std::min<uint64_t>(block_size, entry.size - position));
+			buffer.resize(length);
+			dat_file.readAt(entry.offset + position, buffer.data(), length);
+			position += length;
+			block_size = std::min(block_size * 2, CHUNK_SIZE);
+			data = buffer.data();
+			return length;
+		}
+
+	private:
+		DatFile& dat_file;
+		const MftData& entry;
+		uint64_t position;
+		size_t block_size;
+		std::vector<uint8_t> buffer;
+	};
 
 	// Private methods
 	void validateFileExtension() {
@@ -264,65 +559,154 @@ private:
 	}
 
 	void openFile() {
-		file.open(filename, std::ios::binary | std::ios::ate);
-		if (!file.is_open()) {
+		if (!file.open(filename)) {
 			throw std::runtime_error("Failed to open file: " + filename);
 		}
-		file_size = file.tellg();
-		file.seekg(0, std::ios::beg);
+		file_size = file.size();
+	}
+
+	void mapFile() {
+		if (read_mode == ReadMode::Mapped && !mapped_file.open(filename)) {
+			std::cerr << "Memory mapping unavailable for " << filename << ", falling back to stream reads\n";
+			read_mode = ReadMode::Stream;
+		}
+	}
+
+	// Copies size bytes at offset into dst, from the mapping when available; safe from any thread
+	void readAt(uint64_t offset, void* dst, size_t size) const {
+		if (isMapped()) {
+			ByteSpan span = getEntrySpanAt(offset, size);
+			if (span.size != 0) {
+				std::memcpy(dst, span.data, span.size);
+			}
+			return;
+		}
+
+		if (!file.read(offset, dst, size)) {
+			throw std::runtime_error("Failed to read the full size from file: " + filename + " in offset: " + std::to_string(offset));
+		}
+	}
+
+	DatSearchIndex& getSearchIndex() {
+		if (!search_index_built) {
+			search_index.build(mft_index_data);
+			search_index_built = true;
+		}
+		return search_index;
+	}
+
+	ByteSpan getEntrySpanAt(uint64_t offset, uint64_t size) const {
+		try {
+			return mapped_file.span(offset, size);
+		}
+		catch (const std::out_of_range&) {
+			throw std::runtime_error("Failed to read the full size from file: " + filename + " in offset: " + std::to_string(offset));
+		}
 	}
 
 	void readDatHeader() {
-		file.read(reinterpret_cast<char*>(&dat_header.version), sizeof(dat_header.version));
-		file.read(dat_header.identifier, DAT_MAGIC_NUMBER);
-		file.read(reinterpret_cast<char*>(&dat_header.header_size), sizeof(dat_header.header_size));
-		file.read(reinterpret_cast<char*>(&dat_header.unknown_field), sizeof(dat_header.unknown_field));
-		file.read(reinterpret_cast<char*>(&dat_header.chunk_size), sizeof(dat_header.chunk_size));
-		file.read(reinterpret_cast<char*>(&dat_header.crc), sizeof(dat_header.crc));
-		file.read(reinterpret_cast<char*>(&dat_header.unknown_field_2), sizeof(dat_header.unknown_field_2));
-		file.read(reinterpret_cast<char*>(&dat_header.mft_offset), sizeof(dat_header.mft_offset));
-		file.read(reinterpret_cast<char*>(&dat_header.mft_size), sizeof(dat_header.mft_size));
-		file.read(reinterpret_cast<char*>(&dat_header.flag), sizeof(dat_header.flag));
+		std::vector<uint8_t> storage;
+		const uint8_t* record = readBlock(0, DAT_HEADER_SIZE, storage).data;
+
+		dat_header.version = record[0];
+		std::memcpy(dat_header.identifier, record + 1, DAT_MAGIC_NUMBER);
+		dat_header.header_size = loadField<uint32_t>(record, 4);
+		dat_header.unknown_field = loadField<uint32_t>(record, 8);
+		dat_header.chunk_size = loadField<uint32_t>(record, 12);
+		dat_header.crc = loadField<uint32_t>(record, 16);
+		dat_header.unknown_field_2 = loadField<uint32_t>(record, 20);
+		dat_header.mft_offset = loadField<uint64_t>(record, 24);
+		dat_header.mft_size = loadField<uint32_t>(record, 32);
+		dat_header.flag = loadField<uint32_t>(record, 36);
 	}
 
 	void readMftHeader() {
-		file.seekg(dat_header.mft_offset, std::ios::beg);
-		file.read(mft_header.identifier, MFT_MAGIC_NUMBER);
-		file.read(reinterpret_cast<char*>(&mft_header.unknown_field), sizeof(mft_header.unknown_field));
-		file.read(reinterpret_cast<char*>(&mft_header.mft_entry_size), sizeof(mft_header.mft_entry_size));
-		file.read(reinterpret_cast<char*>(&mft_header.unknown_field_2), sizeof(mft_header.unknown_field_2));
-		file.read(reinterpret_cast<char*>(&mft_header.unknown_field_3), sizeof(mft_header.unknown_field_3));
-		mft_header.mft_entry_size -= 1; // Adjust size based on data format
+		std::vector<uint8_t> storage;
+		unpackMftHeader(readBlock(dat_header.mft_offset, MFT_HEADER_SIZE, storage).data);
 	}
 
+	void unpackMftHeader(const uint8_t* record) {
+		std::memcpy(mft_header.identifier, record, MFT_MAGIC_NUMBER);
+		mft_header.unknown_field = loadField<uint64_t>(record, 4);
+		mft_header.mft_entry_size = loadField<uint32_t>(record, 12);
+		mft_header.unknown_field_2 = loadField<uint32_t>(record, 16);
+		mft_header.unknown_field_3 = loadField<uint32_t>(record, 20);
+		// The header occupies the first entry slot
+		mft_header.mft_entry_size = mft_header.mft_entry_size > 0 ? mft_header.mft_entry_size - 1 : 0;
+	}
+
+	// The whole table is fetched with one read (or viewed in the mapping) and unpacked in place
 	void readMftData() {
-		for (size_t i = 0; i < mft_header.mft_entry_size; ++i) {
-			MftData entry;
-			file.read(reinterpret_cast<char*>(&entry.offset), sizeof(entry.offset));
-			file.read(reinterpret_cast<char*>(&entry.size), sizeof(entry.size));
-			file.read(reinterpret_cast<char*>(&entry.compression_flag), sizeof(entry.compression_flag));
-			file.read(reinterpret_cast<char*>(&entry.entry_flag), sizeof(entry.entry_flag));
-			file.read(reinterpret_cast<char*>(&entry.counter), sizeof(entry.counter));
-			file.read(reinterpret_cast<char*>(&entry.crc), sizeof(entry.crc));
-			mft_data.push_back(entry);
+		uint64_t table_offset = dat_header.mft_offset + MFT_HEADER_SIZE;
+		uint64_t table_size = static_cast<uint64_t>(mft_header.mft_entry_size) * MFT_ENTRY_SIZE;
+		if (table_offset + table_size > file_size) {
+			throw std::runtime_error("MFT table extends past the end of file: " + filename);
+		}
+
+		std::vector<uint8_t> storage;
+		unpackMftData(readBlock(table_offset, static_cast<size_t>(table_size), storage).data);
+	}
+
+	// Unpacks mft_header.mft_entry_size on-disk records
+	void unpackMftData(const uint8_t* record) {
+		mft_data.clear();
+		mft_data.resize(mft_header.mft_entry_size);
+		for (auto& entry : mft_data) {
+			entry.offset = loadField<uint64_t>(record, 0);
+			entry.size = loadField<uint32_t>(record, 8);
+			entry.compression_flag = loadField<uint16_t>(record, 12);
+			entry.entry_flag = loadField<uint16_t>(record, 14);
+			entry.counter = loadField<uint32_t>(record, 16);
+			entry.crc = loadField<uint32_t>(record, 20);
+			record += MFT_ENTRY_SIZE;
 		}
 	}
 
 	void readMftIndexData() {
+		mft_index_data.clear();
 		if (MFT_ENTRY_INDEX_NUM >= mft_data.size()) {
 			return;
 		}
 
 		const auto& entry = mft_data[MFT_ENTRY_INDEX_NUM];
-		size_t num_entries = entry.size / sizeof(MftIndexData);
-		file.seekg(entry.offset, std::ios::beg);
+		size_t num_entries = entry.size / MFT_INDEX_ENTRY_SIZE;
+
+		// (file_id, base_id) pairs match the in-memory layout, so the table is copied as is
+		static_assert(sizeof(MftIndexData) == MFT_INDEX_ENTRY_SIZE, "MftIndexData must match the on-disk layout");
+		mft_index_data.resize(num_entries);
+		if (num_entries != 0) {
+			if (isMapped()) {
+				mapped_file.willNeed(entry.offset, num_entries * MFT_INDEX_ENTRY_SIZE);
+			}
+			readAt(entry.offset, mft_index_data.data(), num_entries * MFT_INDEX_ENTRY_SIZE);
+		}
+	}
+
+	// Fills the MFT tables and search index from a matching sidecar cache
+	bool readCache() {
+		DatCache cache;
+		if (!cache.open(DatCache::pathFor(filename), cacheKey())) {
+			return false;
+		}
+
+		const DatCache::Sections& sections = cache.getSections();
+		if (sections.mft_header.size != MFT_HEADER_SIZE || sections.index_table.size % MFT_INDEX_ENTRY_SIZE != 0) {
+			return false;
+		}
+		unpackMftHeader(sections.mft_header.data);
+		if (sections.mft_table.size != static_cast<uint64_t>(mft_header.mft_entry_size) * MFT_ENTRY_SIZE ||
+			!search_index.deserialize(sections.search_index.data, sections.search_index.size)) {
+			mft_header = MftHeader();
+			return false;
+		}
+		unpackMftData(sections.mft_table.data);
 
-		for (size_t i = 0; i < num_entries; ++i) {
-			MftIndexData index_entry;
-			file.read(reinterpret_cast<char*>(&index_entry.file_id), sizeof(index_entry.file_id));
-			file.read(reinterpret_cast<char*>(&index_entry.base_id), sizeof(index_entry.base_id));
-			mft_index_data.push_back(index_entry);
+		mft_index_data.resize(sections.index_table.size / MFT_INDEX_ENTRY_SIZE);
+		if (!mft_index_data.empty()) {
+			std::memcpy(mft_index_data.data(), sections.index_table.data, sections.index_table.size);
 		}
+		search_index_built = true;
+		return true;
 	}
 };
 
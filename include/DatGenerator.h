@@ -0,0 +1,127 @@
+#ifndef DAT_GENERATOR_H
+#define DAT_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "DatWriter.h"
+#include "DatCompress.h"
+
+// Generates large synthetic archives for load-testing the parse, search, verify and extract
+// paths without the proprietary Gw2.dat.
+//
+// Writing is bound by the disk, not by the encoder: uncompressed payloads are slices of one
+// pool of random bytes, and compressed entries reuse a small set of streams encoded up front.
+// Everything derives from the seed, so the same options give a byte-identical archive.
+class DatGenerator {
+public:
+	struct Options {
+		uint64_t entry_count = 1000000;
+		uint32_t mean_entry_size = 4096; // payload sizes are uniform in [1, 2 * mean)
+		uint32_t compressed_percent = 25;
+		uint32_t alias_percent = 10;     // entries that get a second file_id
+		uint32_t empty_percent = 1;      // unused MFT slots with no data
+		uint64_t seed = 1;
+	};
+
+	struct Progress {
+		uint64_t entries_total = 0;
+		uint64_t entries_done = 0;
+		uint64_t bytes_written = 0;
+	};
+
+	typedef std::function<void(const Progress&)> ProgressCallback;
+
+	static Progress generate(const std::string& file_path, const Options& options, const ProgressCallback& callback = nullptr,
+		std::chrono::milliseconds progress_interval = std::chrono::milliseconds(250)) {
+		std::mt19937_64 rng(options.seed);
+		uint64_t max_size = std::max<uint64_t>(1, 2ull * options.mean_entry_size - 1);
+
+		std::vector<uint8_t> pool(static_cast<size_t>(std::max(static_cast<uint64_t>(POOL_SIZE), max_size)));
+		for (size_t i = 0; i + 8 <= pool.size(); i += 8) {
+			uint64_t value = rng();
+			std::memcpy(&pool[i], &value, 8);
+		}
+		std::vector<std::vector<uint8_t>> compressed_templates = makeCompressedTemplates(options, max_size, rng);
+
+		DatWriter writer(file_path);
+		Progress progress;
+		progress.entries_total = options.entry_count;
+		uint32_t next_file_id = 0;
+		auto newFileId = [&] {
+			next_file_id += 1 + static_cast<uint32_t>(rng() % 4);
+			return next_file_id;
+		};
+
+		auto last_report = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < options.entry_count; ++i) {
+			uint32_t roll = static_cast<uint32_t>(rng() % 100);
+			uint32_t mft_index;
+			if (roll < options.empty_percent) {
+				mft_index = writer.addRawEntry(nullptr, 0, 0, newFileId());
+			}
+			else if (roll < options.empty_percent + options.compressed_percent) {
+				const auto& stream = compressed_templates[rng() % compressed_templates.size()];
+				mft_index = writer.addRawEntry(stream.data(), stream.size(), DatWriter::COMPRESSED_FLAG, newFileId());
+			}
+			else {
+				size_t size = static_cast<size_t>(1 + rng() % max_size);
+				size_t start = static_cast<size_t>(rng() % (pool.size() - size + 1));
+				mft_index = writer.addRawEntry(pool.data() + start, size, 0, newFileId());
+			}
+
+			if (rng() % 100 < options.alias_percent) {
+				writer.addFileId(mft_index, newFileId());
+			}
+
+			if (callback && (i & 1023) == 0) {
+				auto now = std::chrono::steady_clock::now();
+				if (now - last_report >= progress_interval) {
+					progress.entries_done = i;
+					progress.bytes_written = writer.getBytesWritten();
+					callback(progress);
+					last_report = now;
+				}
+			}
+		}
+
+		writer.finish();
+		progress.entries_done = options.entry_count;
+		progress.bytes_written = writer.getBytesWritten();
+		if (callback) {
+			callback(progress);
+		}
+		return progress;
+	}
+
+private:
+	static constexpr size_t POOL_SIZE = 32u << 20;
+	static constexpr size_t TEMPLATE_COUNT = 16;
+	static constexpr uint64_t MAX_TEMPLATE_SIZE = 1u << 20; // keeps the encoder time bounded
+
+	// Compressible input: words from a small alphabet with occasional random bytes
+	static std::vector<std::vector<uint8_t>> makeCompressedTemplates(const Options& options, uint64_t max_size, std::mt19937_64& rng) {
+		std::vector<std::vector<uint8_t>> templates;
+		if (options.compressed_percent == 0) {
+			return templates;
+		}
+
+		DatCompressor compressor;
+		for (size_t i = 0; i < TEMPLATE_COUNT; ++i) {
+			std::vector<uint8_t> data(static_cast<size_t>(1 + rng() % std::min(max_size, static_cast<uint64_t>(MAX_TEMPLATE_SIZE))));
+			for (auto& byte : data) {
+				byte = rng() % 16 == 0 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>('a' + rng() % 6);
+			}
+			templates.push_back(compressor.compress(data.data(), data.size()));
+		}
+		return templates;
+	}
+};
+
+#endif // !DAT_GENERATOR_H
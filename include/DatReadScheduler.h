@@ -0,0 +1,132 @@
+#ifndef DAT_READ_SCHEDULER_H
+#define DAT_READ_SCHEDULER_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "DatFile.h"
+
+// Reads batches of entries with few, large, sequential reads.
+//
+// A batch of MFT indices is sorted by archive offset and cut into runs: neighbouring entries
+// join a run while the unrequested bytes between them stay within max_gap and the run within
+// max_read. Each run is one read into a reused buffer, sliced back into per-entry views, so
+// entries laid out back to back cost one request instead of one each. In Mapped mode the runs
+// are views of the mapping and nothing is copied. One scheduler per thread.
+class DatReadScheduler {
+public:
+	struct Options {
+		uint64_t max_gap = 64ull << 10; // unrequested bytes read through to join two entries
+		uint64_t max_read = 8ull << 20; // runs stop growing here; a larger entry is read alone
+	};
+
+	// Entries [begin, end) of the sorted batch, read as one range
+	struct Run {
+		uint64_t offset;
+		uint64_t size;
+		size_t begin;
+		size_t end;
+	};
+
+	struct Stats {
+		uint64_t entries = 0;
+		uint64_t reads = 0;
+		uint64_t bytes_read = 0;
+		uint64_t gap_bytes = 0; // read only to join entries
+	};
+
+	explicit DatReadScheduler(DatFile& dat_file) : dat_file(dat_file) {}
+
+	DatReadScheduler(DatFile& dat_file, const Options& options) : dat_file(dat_file), options(options) {}
+
+	// Sorts mft_indices by offset and groups them into runs
+	std::vector<Run> plan(std::vector<uint32_t>& mft_indices) const {
+		const auto& mft_data = dat_file.getMftData();
+		std::sort(mft_indices.begin(), mft_indices.end(), [&](uint32_t a, uint32_t b) {
+			return mft_data[a].offset < mft_data[b].offset;
+		});
+
+		std::vector<Run> runs;
+		for (size_t i = 0; i < mft_indices.size(); ++i) {
+			const DatFile::MftData& entry = mft_data[mft_indices[i]];
+			uint64_t entry_end = entry.offset + entry.size;
+			if (!runs.empty()) {
+				Run& run = runs.back();
+				uint64_t run_end = run.offset + run.size;
+				uint64_t merged_end = std::max(run_end, entry_end);
+				if (entry.offset <= run_end + options.max_gap && merged_end - run.offset <= options.max_read) {
+					run.size = merged_end - run.offset;
+					run.end = i + 1;
+					continue;
+				}
+			}
+			runs.push_back({ entry.offset, entry.size, i, i + 1 });
+		}
+		return runs;
+	}
+
+	// Reads the entries of mft_indices and calls visit(mft_index, raw) for each, in archive
+	// order; raw holds the entry's raw bytes and is only valid during the call. When a run
+	// cannot be read its entries are read one by one, and fail(mft_index, error) is called for
+	// each one that still fails.
+	template <typename Visitor, typename FailureHandler>
+	void read(std::vector<uint32_t> mft_indices, Visitor visit, FailureHandler fail) {
+		const auto& mft_data = dat_file.getMftData();
+		for (const Run& run : plan(mft_indices)) {
+			uint64_t requested = 0;
+			for (size_t i = run.begin; i < run.end; ++i) {
+				requested += mft_data[mft_indices[i]].size;
+			}
+			stats.entries += run.end - run.begin;
+			stats.gap_bytes += run.size > requested ? run.size - requested : 0;
+
+			ByteSpan data;
+			try {
+				data = readRun(run);
+			}
+			catch (const std::exception&) {
+				for (size_t i = run.begin; i < run.end; ++i) {
+					readAlone(mft_indices[i], visit, fail);
+				}
+				continue;
+			}
+			for (size_t i = run.begin; i < run.end; ++i) {
+				const DatFile::MftData& entry = mft_data[mft_indices[i]];
+				visit(mft_indices[i], data.subspan(static_cast<size_t>(entry.offset - run.offset), entry.size));
+			}
+		}
+	}
+
+	const Stats& getStats() const {
+		return stats;
+	}
+
+private:
+	DatFile& dat_file;
+	Options options;
+	std::vector<uint8_t> buffer;
+	Stats stats;
+
+	ByteSpan readRun(const Run& run) {
+		stats.reads++;
+		stats.bytes_read += run.size;
+		return dat_file.readBlock(run.offset, static_cast<size_t>(run.size), buffer);
+	}
+
+	template <typename Visitor, typename FailureHandler>
+	void readAlone(uint32_t mft_index, Visitor& visit, FailureHandler& fail) {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+		ByteSpan data;
+		try {
+			data = readRun({ entry.offset, entry.size, 0, 1 });
+		}
+		catch (const std::exception& e) {
+			fail(mft_index, e);
+			return;
+		}
+		visit(mft_index, data);
+	}
+};
+
+#endif // !DAT_READ_SCHEDULER_H
@@ -0,0 +1,458 @@
+#ifndef DAT_SEARCH_INDEX_H
+#define DAT_SEARCH_INDEX_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <iterator>
+#include <cstring>
+
+// Search index over the MFT index table (file_id -> base_id).
+//
+// Results are the distinct base_ids whose base_id, or one of whose file_ids, contains the
+// queried number as a decimal substring, in ascending order. Every search key is indexed
+// by its digit trigrams: three-digit queries are answered straight from a posting list,
+// longer queries intersect the posting lists of their trigrams and verify the survivors.
+// One and two digit queries match a large share of the archive, so their result counts
+// are precomputed and the matches are scanned lazily as pages are requested.
+class DatSearchIndex {
+public:
+	enum class Key {
+		FileId = 0,
+		BaseId = 1
+	};
+
+	// Paged view over the results of one query; only valid while the index is unchanged
+	class Results {
+	public:
+		Results() : index(nullptr), kind(Kind::Materialized), key(Key::BaseId), query(0), divisor(1),
+			posting_begin(nullptr), total(0), scan_position(0) {
+		}
+
+		size_t size() const {
+			return total;
+		}
+
+		bool empty() const {
+			return total == 0;
+		}
+
+		// base_ids [offset, offset + count) of the results
+		std::vector<uint32_t> page(size_t offset, size_t count) {
+			std::vector<uint32_t> base_ids;
+			if (offset >= total) {
+				return base_ids;
+			}
+			count = std::min(count, total - offset);
+			base_ids.reserve(count);
+
+			const uint32_t* items = nullptr;
+			if (kind == Kind::Posting) {
+				items = posting_begin;
+			}
+			else {
+				if (kind == Kind::Scan) {
+					scanUntil(offset + count);
+				}
+				items = matches.data();
+			}
+
+			for (size_t i = offset; i < offset + count; ++i) {
+				base_ids.push_back(index->base_ids[items[i]]);
+			}
+			return base_ids;
+		}
+
+		std::vector<uint32_t> all() {
+			return page(0, total);
+		}
+
+	private:
+		friend class DatSearchIndex;
+
+		enum class Kind {
+			Posting,      // slice of a trigram posting list
+			Materialized, // verified matches
+			Scan          // matches found lazily by walking every item
+		};
+
+		const DatSearchIndex* index;
+		Kind kind;
+		Key key;
+		uint32_t query;
+		uint32_t divisor;
+		const uint32_t* posting_begin;
+		size_t total;
+		std::vector<uint32_t> matches;
+		uint32_t scan_position;
+
+		void scanUntil(size_t match_count) {
+			const uint32_t item_count = static_cast<uint32_t>(index->base_ids.size());
+			while (matches.size() < match_count && scan_position < item_count) {
+				if (index->itemMatches(key, scan_position, query, divisor)) {
+					matches.push_back(scan_position);
+				}
+				++scan_position;
+			}
+		}
+	};
+
+	DatSearchIndex() : built_keys{ false, false } {}
+
+	// index_data holds records with file_id and base_id members
+	template <typename IndexData>
+	void build(const std::vector<IndexData>& index_data) {
+		base_ids.clear();
+		file_ids_by_base.clear();
+		for (auto& key_index : key_indices) {
+			key_index = KeyIndex();
+		}
+		built_keys[0] = built_keys[1] = false;
+
+		// (base_id, file_id) sorted by base_id gives the items and their file ids in one pass
+		std::vector<std::pair<uint32_t, uint32_t>> by_base;
+		by_base.reserve(index_data.size());
+		file_ids_by_base.reserve(index_data.size());
+		for (const auto& entry : index_data) {
+			by_base.emplace_back(entry.base_id, entry.file_id);
+			file_ids_by_base.emplace_back(entry.file_id, entry.base_id);
+		}
+		std::sort(by_base.begin(), by_base.end());
+		std::sort(file_ids_by_base.begin(), file_ids_by_base.end());
+
+		base_ids.reserve(by_base.size());
+		item_file_offsets.clear();
+		item_file_ids.clear();
+		item_file_ids.reserve(by_base.size());
+		for (const auto& pair : by_base) {
+			if (base_ids.empty() || base_ids.back() != pair.first) {
+				base_ids.push_back(pair.first);
+				item_file_offsets.push_back(static_cast<uint32_t>(item_file_ids.size()));
+			}
+			item_file_ids.push_back(pair.second);
+		}
+		item_file_offsets.push_back(static_cast<uint32_t>(item_file_ids.size()));
+	}
+
+	// MFT entries (base_ids) whose file_id or base_id is exactly id
+	std::vector<uint32_t> findExact(uint32_t id, Key key) const {
+		std::vector<uint32_t> found;
+		if (key == Key::BaseId) {
+			if (std::binary_search(base_ids.begin(), base_ids.end(), id)) {
+				found.push_back(id);
+			}
+			return found;
+		}
+
+		auto range = std::equal_range(file_ids_by_base.begin(), file_ids_by_base.end(), std::make_pair(id, 0u),
+			[](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+				return a.first < b.first;
+			});
+		for (auto it = range.first; it != range.second; ++it) {
+			found.push_back(it->second);
+		}
+		std::sort(found.begin(), found.end());
+		found.erase(std::unique(found.begin(), found.end()), found.end());
+		return found;
+	}
+
+	// MFT entries (base_ids) whose key contains query as a decimal substring
+	Results find(uint32_t query, Key key) {
+		ensureBuilt(key);
+		const KeyIndex& key_index = key_indices[static_cast<int>(key)];
+
+		std::string digits = std::to_string(query);
+		Results results;
+		results.index = this;
+		results.key = key;
+		results.query = query;
+		for (size_t i = 0; i < digits.size(); ++i) {
+			results.divisor *= 10;
+		}
+
+		if (digits.size() <= 2) {
+			results.kind = Results::Kind::Scan;
+			results.total = digits.size() == 1 ? key_index.digit_counts[query] : key_index.pair_counts[query];
+			return results;
+		}
+
+		if (digits.size() == 3) {
+			uint32_t gram = trigramOf(digits, 0);
+			results.kind = Results::Kind::Posting;
+			results.posting_begin = key_index.posting_items.data() + key_index.posting_offsets[gram];
+			results.total = key_index.posting_offsets[gram + 1] - key_index.posting_offsets[gram];
+			return results;
+		}
+
+		// Intersect the trigram posting lists, shortest first
+		std::vector<uint32_t> grams;
+		for (size_t i = 0; i + 3 <= digits.size(); ++i) {
+			grams.push_back(trigramOf(digits, i));
+		}
+		std::sort(grams.begin(), grams.end(), [&](uint32_t a, uint32_t b) {
+			return postingSize(key_index, a) < postingSize(key_index, b);
+		});
+
+		std::vector<uint32_t> candidates(key_index.posting_items.begin() + key_index.posting_offsets[grams[0]],
+			key_index.posting_items.begin() + key_index.posting_offsets[grams[0] + 1]);
+		for (size_t g = 1; g < grams.size() && !candidates.empty(); ++g) {
+			auto begin = key_index.posting_items.begin() + key_index.posting_offsets[grams[g]];
+			auto end = key_index.posting_items.begin() + key_index.posting_offsets[grams[g] + 1];
+			std::vector<uint32_t> intersection;
+			std::set_intersection(candidates.begin(), candidates.end(), begin, end, std::back_inserter(intersection));
+			candidates.swap(intersection);
+		}
+
+		results.kind = Results::Kind::Materialized;
+		for (uint32_t item : candidates) {
+			if (itemMatches(key, item, query, results.divisor)) {
+				results.matches.push_back(item);
+			}
+		}
+		results.total = results.matches.size();
+		return results;
+	}
+
+	size_t size() const {
+		return base_ids.size();
+	}
+
+	// Flat copy of the index with both keys built, for the sidecar cache
+	std::vector<uint8_t> serialize() {
+		ensureBuilt(Key::FileId);
+		ensureBuilt(Key::BaseId);
+
+		std::vector<uint32_t> file_id_pairs;
+		file_id_pairs.reserve(file_ids_by_base.size() * 2);
+		for (const auto& pair : file_ids_by_base) {
+			file_id_pairs.push_back(pair.first);
+			file_id_pairs.push_back(pair.second);
+		}
+
+		std::vector<uint8_t> output;
+		appendArray(output, base_ids.data(), base_ids.size());
+		appendArray(output, file_id_pairs.data(), file_id_pairs.size());
+		appendArray(output, item_file_offsets.data(), item_file_offsets.size());
+		appendArray(output, item_file_ids.data(), item_file_ids.size());
+		for (const auto& key_index : key_indices) {
+			appendArray(output, key_index.posting_offsets.data(), key_index.posting_offsets.size());
+			appendArray(output, key_index.posting_items.data(), key_index.posting_items.size());
+			appendArray(output, key_index.digit_counts, 10);
+			appendArray(output, key_index.pair_counts, 100);
+		}
+		return output;
+	}
+
+	// Restores an index written by serialize(); false leaves the index empty
+	bool deserialize(const uint8_t* data, size_t size) {
+		const uint8_t* cursor = data;
+		const uint8_t* end = data + size;
+		std::vector<uint32_t> file_id_pairs;
+		std::vector<uint32_t> digit_counts;
+		std::vector<uint32_t> pair_counts;
+
+		bool valid = readArray(cursor, end, base_ids) && readArray(cursor, end, file_id_pairs) &&
+			readArray(cursor, end, item_file_offsets) && readArray(cursor, end, item_file_ids) &&
+			file_id_pairs.size() % 2 == 0 && item_file_offsets.size() == base_ids.size() + 1;
+		for (auto& key_index : key_indices) {
+			valid = valid && readArray(cursor, end, key_index.posting_offsets) && readArray(cursor, end, key_index.posting_items) &&
+				readArray(cursor, end, digit_counts) && readArray(cursor, end, pair_counts) &&
+				key_index.posting_offsets.size() == TRIGRAM_COUNT + 1 && digit_counts.size() == 10 && pair_counts.size() == 100 &&
+				key_index.posting_offsets.back() == key_index.posting_items.size();
+			if (valid) {
+				std::copy(digit_counts.begin(), digit_counts.end(), key_index.digit_counts);
+				std::copy(pair_counts.begin(), pair_counts.end(), key_index.pair_counts);
+			}
+		}
+
+		if (!valid || cursor != end) {
+			*this = DatSearchIndex();
+			return false;
+		}
+
+		file_ids_by_base.clear();
+		file_ids_by_base.reserve(file_id_pairs.size() / 2);
+		for (size_t i = 0; i < file_id_pairs.size(); i += 2) {
+			file_ids_by_base.emplace_back(file_id_pairs[i], file_id_pairs[i + 1]);
+		}
+		built_keys[0] = built_keys[1] = true;
+		return true;
+	}
+
+private:
+	static constexpr uint32_t TRIGRAM_COUNT = 1000;
+
+	struct KeyIndex {
+		std::vector<uint32_t> posting_offsets;
+		std::vector<uint32_t> posting_items;
+		uint32_t digit_counts[10] = {};
+		uint32_t pair_counts[100] = {};
+	};
+
+	std::vector<uint32_t> base_ids;
+	std::vector<std::pair<uint32_t, uint32_t>> file_ids_by_base; // (file_id, base_id) sorted
+	std::vector<uint32_t> item_file_offsets;
+	std::vector<uint32_t> item_file_ids;
+	KeyIndex key_indices[2];
+	bool built_keys[2];
+
+	// Arrays are stored as (u64 count, u32 values)
+	static void appendArray(std::vector<uint8_t>& output, const uint32_t* values, size_t count) {
+		uint64_t stored_count = count;
+		const uint8_t* count_bytes = reinterpret_cast<const uint8_t*>(&stored_count);
+		output.insert(output.end(), count_bytes, count_bytes + sizeof(stored_count));
+		const uint8_t* value_bytes = reinterpret_cast<const uint8_t*>(values);
+		output.insert(output.end(), value_bytes, value_bytes + count * sizeof(uint32_t));
+	}
+
+	static bool readArray(const uint8_t*& cursor, const uint8_t* end, std::vector<uint32_t>& values) {
+		uint64_t count;
+		if (static_cast<size_t>(end - cursor) < sizeof(count)) {
+			return false;
+		}
+		std::memcpy(&count, cursor, sizeof(count));
+		cursor += sizeof(count);
+		if (count > static_cast<size_t>(end - cursor) / sizeof(uint32_t)) {
+			return false;
+		}
+		values.resize(static_cast<size_t>(count));
+		if (count != 0) {
+			std::memcpy(values.data(), cursor, static_cast<size_t>(count) * sizeof(uint32_t));
+		}
+		cursor += count * sizeof(uint32_t);
+		return true;
+	}
+
+	static uint32_t trigramOf(const std::string& digits, size_t position) {
+		return (digits[position] - '0') * 100 + (digits[position + 1] - '0') * 10 + (digits[position + 2] - '0');
+	}
+
+	static size_t postingSize(const KeyIndex& key_index, uint32_t gram) {
+		return key_index.posting_offsets[gram + 1] - key_index.posting_offsets[gram];
+	}
+
+	// Same digit test as the original linear search: does value contain query in decimal
+	static bool containsDigits(uint32_t value, uint32_t query, uint32_t divisor) {
+		if (query == 0) {
+			do {
+				if (value % 10 == 0) {
+					return true;
+				}
+				value /= 10;
+			} while (value > 0);
+			return false;
+		}
+
+		while (value >= query) {
+			if (value % divisor == query) {
+				return true;
+			}
+			value /= 10;
+		}
+		return false;
+	}
+
+	template <typename Visitor>
+	void forEachKey(Key key, uint32_t item, Visitor visit) const {
+		if (key == Key::BaseId) {
+			visit(base_ids[item]);
+			return;
+		}
+		for (uint32_t i = item_file_offsets[item]; i < item_file_offsets[item + 1]; ++i) {
+			visit(item_file_ids[i]);
+		}
+	}
+
+	bool itemMatches(Key key, uint32_t item, uint32_t query, uint32_t divisor) const {
+		bool matched = false;
+		forEachKey(key, item, [&](uint32_t value) {
+			matched = matched || containsDigits(value, query, divisor);
+		});
+		return matched;
+	}
+
+	// Distinct digit n-grams of an item's keys, as flags indexed by n-gram value
+	template <typename Visitor>
+	void forEachGram(Key key, uint32_t item, std::vector<uint8_t>& seen, std::vector<uint32_t>& touched, Visitor visit) const {
+		forEachKey(key, item, [&](uint32_t value) {
+			// Decimal digits, most significant first
+			uint8_t digits[10];
+			size_t digit_count = 0;
+			do {
+				digits[digit_count++] = static_cast<uint8_t>(value % 10);
+				value /= 10;
+			} while (value > 0);
+			std::reverse(digits, digits + digit_count);
+
+			for (size_t length = 1; length <= 3; ++length) {
+				for (size_t i = 0; i + length <= digit_count; ++i) {
+					uint32_t gram = 0;
+					for (size_t j = 0; j < length; ++j) {
+						gram = gram * 10 + digits[i + j];
+					}
+					// Slots: 0-9 digits, 10-109 pairs, 110-1109 trigrams
+					uint32_t slot = length == 1 ? gram : (length == 2 ? 10 + gram : 110 + gram);
+					if (!seen[slot]) {
+						seen[slot] = 1;
+						touched.push_back(slot);
+						visit(slot);
+					}
+				}
+			}
+		});
+		for (uint32_t slot : touched) {
+			seen[slot] = 0;
+		}
+		touched.clear();
+	}
+
+	void ensureBuilt(Key key) {
+		int key_slot = static_cast<int>(key);
+		if (built_keys[key_slot]) {
+			return;
+		}
+
+		KeyIndex& key_index = key_indices[key_slot];
+		key_index = KeyIndex();
+		key_index.posting_offsets.assign(TRIGRAM_COUNT + 1, 0);
+
+		std::vector<uint8_t> seen(110 + TRIGRAM_COUNT, 0);
+		std::vector<uint32_t> touched;
+		const uint32_t item_count = static_cast<uint32_t>(base_ids.size());
+
+		// Counting pass
+		for (uint32_t item = 0; item < item_count; ++item) {
+			forEachGram(key, item, seen, touched, [&](uint32_t slot) {
+				if (slot < 10) {
+					++key_index.digit_counts[slot];
+				}
+				else if (slot < 110) {
+					++key_index.pair_counts[slot - 10];
+				}
+				else {
+					++key_index.posting_offsets[slot - 110 + 1];
+				}
+			});
+		}
+		for (uint32_t gram = 1; gram <= TRIGRAM_COUNT; ++gram) {
+			key_index.posting_offsets[gram] += key_index.posting_offsets[gram - 1];
+		}
+
+		// Fill pass; items arrive in ascending order so every posting list is sorted
+		key_index.posting_items.resize(key_index.posting_offsets[TRIGRAM_COUNT]);
+		std::vector<uint32_t> fill(key_index.posting_offsets.begin(), key_index.posting_offsets.end() - 1);
+		for (uint32_t item = 0; item < item_count; ++item) {
+			forEachGram(key, item, seen, touched, [&](uint32_t slot) {
+				if (slot >= 110) {
+					key_index.posting_items[fill[slot - 110]++] = item;
+				}
+			});
+		}
+
+		built_keys[key_slot] = true;
+	}
+};
+
+#endif // !DAT_SEARCH_INDEX_H
@@ -0,0 +1,652 @@
+#ifndef DAT_SEEKABLE_ENTRY_H
+#define DAT_SEEKABLE_ENTRY_H
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+#include "DatFile.h"
+#include "DatCache.h"
+#include "DatDecompress.h"
+#include "Crc32c.h"
+
+// Random access into the decompressed bytes of one entry, for views of entries too large to
+// inflate whole.
+//
+// Uncompressed entries map an offset straight to its chunk. Compressed ones keep a checkpoint
+// every interval bytes of output: the bit reader position, the decoder state and the 128 KiB of
+// output before it that copies can reach back into. A read decodes from the nearest checkpoint
+// at or before its offset and records the checkpoints it passes, so once an entry is indexed a
+// jump costs at most one interval of decoding. startIndexing() records them all in the
+// background; they are then kept in a sidecar file, tied to the archive like DatCache, so the
+// next visit starts indexed. Sidecars of every archive share one folder in the per-user cache
+// directory, whose total size is capped by SIDECAR_BUDGET: saving one deletes the least
+// recently used others past it.
+//
+// read() decodes on the calling thread. A UI uses tryRead() instead, which never decodes: it
+// queues the range for a worker and reports whether the bytes are ready. Construction only reads
+// the stream header; the compressed input and the sidecar are loaded by whichever thread first
+// decodes.
+class DatSeekableEntry {
+public:
+	static constexpr uint64_t DEFAULT_INTERVAL = 4ull << 20;
+	static constexpr size_t WINDOW_SIZE = 128 * 1024;
+	static constexpr uint32_t FORMAT_VERSION = 1;
+	static constexpr uint64_t SIDECAR_BUDGET = 256ull << 20;
+
+	DatSeekableEntry(DatFile& dat_file, uint32_t mft_index, bool use_sidecar = true, uint64_t interval = DEFAULT_INTERVAL) :
+		dat_file(dat_file), mft_index(mft_index), use_sidecar(use_sidecar), interval(std::max<uint64_t>(interval, 64 * 1024)),
+		size(0), indexed(false), saved_count(0), cancelled(false) {
+		if (mft_index >= dat_file.getMftData().size()) {
+			throw std::out_of_range("MFT index out of range: " + std::to_string(mft_index));
+		}
+		entry = dat_file.getMftData()[mft_index];
+		sidecar_path = sidecarFolder(dat_file.getFilename()) + "/" + DatCache::archiveTag(dat_file.getFilename()) + "-" +
+			std::to_string(mft_index);
+
+		if (entry.compression_flag == 0) {
+			size = DatFile::payloadSize(entry.size);
+			indexed = true;
+		}
+		else {
+			size = dat_file.readUncompressedSize(entry);
+		}
+	}
+
+	~DatSeekableEntry() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cancelled = true;
+		}
+		condition.notify_all();
+		if (indexer.joinable()) {
+			indexer.join();
+		}
+		if (page_worker.joinable()) {
+			page_worker.join();
+		}
+	}
+
+	DatSeekableEntry(const DatSeekableEntry&) = delete;
+	DatSeekableEntry& operator=(const DatSeekableEntry&) = delete;
+
+	uint32_t getMftIndex() const {
+		return mft_index;
+	}
+
+	// Decompressed size
+	uint64_t getSize() const {
+		return size;
+	}
+
+	// Output up to which any offset can be reached within one interval of decoding
+	uint64_t getIndexedSize() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (indexed || checkpoints.empty()) {
+			return indexed ? size : 0;
+		}
+		return std::min(size, (checkpoints.size() - 1) * interval);
+	}
+
+	bool isIndexed() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return indexed;
+	}
+
+	// Why the background indexing stopped, empty while it runs or once it has finished
+	std::string getIndexError() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return index_error;
+	}
+
+	// Copies length decompressed bytes at offset into buffer; throws when they cannot be decoded
+	void read(uint64_t offset, uint8_t* buffer, size_t length) {
+		if (offset > size || length > size - offset) {
+			throw std::out_of_range("Read past the end of entry " + std::to_string(mft_index));
+		}
+		if (entry.compression_flag == 0) {
+			readPayload(offset, buffer, length);
+		}
+		else {
+			prepare();
+			decode(offset, buffer, length);
+		}
+	}
+
+	// Non-blocking read: copies the bytes and returns true once a worker has decoded them,
+	// otherwise queues the range and returns false, to be asked again on a later frame.
+	// Uncompressed entries are read directly. Throws when the range could not be decoded.
+	bool tryRead(uint64_t offset, uint8_t* buffer, size_t length) {
+		if (entry.compression_flag == 0) {
+			read(offset, buffer, length);
+			return true;
+		}
+		if (offset > size || length > size - offset) {
+			throw std::out_of_range("Read past the end of entry " + std::to_string(mft_index));
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const PageResult& result : page_results) {
+			if (result.offset == offset && result.bytes.size() == length) {
+				if (!result.error.empty()) {
+					throw std::runtime_error(result.error);
+				}
+				std::memcpy(buffer, result.bytes.data(), length);
+				return true;
+			}
+		}
+
+		// The newest request is served first; one asked for again moves to the front
+		auto queued = std::find_if(page_requests.begin(), page_requests.end(),
+			[&](const PageRequest& request) { return request.offset == offset && request.length == length; });
+		if (queued != page_requests.end()) {
+			page_requests.erase(queued);
+		}
+		else if (page_requests.size() >= MAX_PAGE_REQUESTS) {
+			page_requests.pop_front();
+		}
+		page_requests.push_back({ offset, length });
+
+		if (!page_worker.joinable()) {
+			page_worker = std::thread([this] { pageLoop(); });
+		}
+		condition.notify_all();
+		return false;
+	}
+
+	// Records every checkpoint on a background thread, then saves them to the sidecar
+	void startIndexing() {
+		if (isIndexed() || indexer.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			indexing = true;
+		}
+		indexer = std::thread([this] {
+			try {
+				prepare();
+				bool loaded_indexed;
+				uint64_t start;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					loaded_indexed = indexed;
+					start = (checkpoints.size() - 1) * interval;
+				}
+				if (!loaded_indexed) {
+					decode(start, nullptr, static_cast<size_t>(size - start));
+					if (use_sidecar) {
+						saveCheckpoints();
+					}
+				}
+			}
+			catch (const std::exception& e) {
+				std::lock_guard<std::mutex> lock(mutex);
+				index_error = e.what();
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				indexing = false;
+			}
+			condition.notify_all();
+		});
+	}
+
+	// checkpoints/ in the per-user cache directory (see DatCache), or <archive>.checkpoints when
+	// there is none
+	static std::string sidecarFolder(const std::string& archive_path) {
+		std::string cache_directory = DatCache::directory();
+		return cache_directory.empty() ? archive_path + ".checkpoints" : cache_directory + "/checkpoints";
+	}
+
+	std::string sidecarPath() const {
+		return sidecar_path;
+	}
+
+	// Deletes the least recently used sidecars in folder until the rest fit byte_budget; keep is
+	// never deleted. Returns the bytes left.
+	static uint64_t trimSidecars(const std::string& folder, uint64_t byte_budget, const std::string& keep = std::string()) {
+		struct SidecarFile {
+			std::string path;
+			uint64_t size;
+			int64_t modification_time;
+		};
+		std::vector<SidecarFile> files;
+		auto addFile = [&](const std::string& name, uint64_t file_size, int64_t modification_time) {
+			// Files still being written are left to their writer
+			if (name.size() < 5 || name.compare(name.size() - 5, 5, ".part") != 0) {
+				files.push_back({ folder + "/" + name, file_size, modification_time });
+			}
+		};
+#ifdef _WIN32
+		struct __finddata64_t found;
+		intptr_t handle = _findfirst64((folder + "/*").c_str(), &found);
+		if (handle != -1) {
+			do {
+				if ((found.attrib & _A_SUBDIR) == 0) {
+					addFile(found.name, static_cast<uint64_t>(found.size), static_cast<int64_t>(found.time_write));
+				}
+			} while (_findnext64(handle, &found) == 0);
+			_findclose(handle);
+		}
+#else
+		if (DIR* directory = opendir(folder.c_str())) {
+			while (dirent* item = readdir(directory)) {
+				struct stat file_stat;
+				if (stat((folder + "/" + item->d_name).c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+					addFile(item->d_name, static_cast<uint64_t>(file_stat.st_size), static_cast<int64_t>(file_stat.st_mtime));
+				}
+			}
+			closedir(directory);
+		}
+#endif
+
+		uint64_t total = 0;
+		for (const SidecarFile& file : files) {
+			total += file.size;
+		}
+		std::sort(files.begin(), files.end(), [](const SidecarFile& a, const SidecarFile& b) {
+			return a.modification_time < b.modification_time;
+		});
+		for (const SidecarFile& file : files) {
+			if (total <= byte_budget) {
+				break;
+			}
+			if (file.path != keep && std::remove(file.path.c_str()) == 0) {
+				total -= file.size;
+			}
+		}
+		return total;
+	}
+
+	// Writes the checkpoints recorded so far, if there are new ones; false when that fails
+	bool saveCheckpoints() {
+		std::vector<uint8_t> file;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (entry.compression_flag == 0 || checkpoints.size() <= saved_count) {
+				return true;
+			}
+			file = serialize();
+			saved_count = checkpoints.size();
+		}
+
+		// Written under a temporary name and renamed, so readers never see a partial file
+		const std::string& path = sidecar_path;
+		if (!DatCache::canWrite(path)) {
+			return false;
+		}
+		std::string temporary_path = path + ".part";
+		{
+			std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+			output.write(reinterpret_cast<const char*>(file.data()), file.size());
+			if (!output) {
+				output.close();
+				std::remove(temporary_path.c_str());
+				return false;
+			}
+		}
+		std::remove(path.c_str());
+		if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+			std::remove(temporary_path.c_str());
+			return false;
+		}
+		trimSidecars(sidecarFolder(dat_file.getFilename()), SIDECAR_BUDGET, path);
+		return true;
+	}
+
+private:
+	// magic, version, header crc, payload checksum, mft offset, file size, mtime, entry offset,
+	// entry size, checkpoint count, interval, decompressed size, flags
+	static constexpr size_t HEADER_SIZE = 80;
+	static constexpr uint32_t MAGIC = 0x53565747; // "GWVS"
+	static constexpr uint32_t FLAG_INDEXED = 1;
+	static constexpr size_t MAX_PAGE_REQUESTS = 8;
+	static constexpr size_t MAX_PAGE_RESULTS = 16;
+
+	struct Checkpoint {
+		DatBitReader::Position position;
+		DatDecompressor::State state;
+		std::vector<uint8_t> window; // output just before the checkpoint, up to WINDOW_SIZE bytes
+	};
+
+	struct PageRequest {
+		uint64_t offset;
+		size_t length;
+	};
+
+	struct PageResult {
+		uint64_t offset;
+		std::vector<uint8_t> bytes;
+		std::string error;
+	};
+
+	DatFile& dat_file;
+	uint32_t mft_index;
+	DatFile::MftData entry;
+	std::string sidecar_path;
+	bool use_sidecar;
+	uint64_t interval;
+	uint64_t size;
+	std::once_flag prepared;
+	std::vector<uint8_t> raw_storage;
+	ByteSpan raw;
+	mutable std::mutex mutex;
+	std::condition_variable condition; // page requests, new checkpoints, end of indexing, cancel
+	std::vector<Checkpoint> checkpoints; // checkpoint k is at output offset k * interval
+	bool indexed;
+	bool indexing = false;
+	size_t saved_count;
+	std::string index_error;
+	std::atomic<bool> cancelled;
+	std::thread indexer;
+	std::deque<PageRequest> page_requests;
+	std::deque<PageResult> page_results; // oldest first, at most MAX_PAGE_RESULTS
+	std::thread page_worker;
+
+	// Loads the compressed input and the checkpoints, once, on the first thread that decodes
+	void prepare() {
+		std::call_once(prepared, [this] {
+			// The decoder wants the whole raw entry; a view in Mapped mode, a copy otherwise
+			if (dat_file.isMapped()) {
+				raw = dat_file.getEntrySpan(entry);
+			}
+			else {
+				raw_storage = dat_file.readCompressedData(entry);
+				raw = ByteSpan(raw_storage.data(), raw_storage.size());
+			}
+
+			DatBitReader reader(raw.data, raw.size, true);
+			Checkpoint first;
+			first.state = DatDecompressor::begin(reader);
+			first.position = reader.getPosition();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				checkpoints.push_back(std::move(first));
+			}
+
+			if (use_sidecar && loadCheckpoints()) {
+				std::lock_guard<std::mutex> lock(mutex);
+				saved_count = checkpoints.size();
+			}
+		});
+	}
+
+	// Serves tryRead. While the indexer runs, a request past its progress waits for it instead
+	// of decoding the same stretch a second time.
+	void pageLoop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			condition.wait(lock, [this] {
+				return cancelled || (!page_requests.empty() &&
+					(!indexing || page_requests.back().offset / interval < checkpoints.size()));
+			});
+			if (cancelled) {
+				return;
+			}
+			PageRequest request = page_requests.back();
+			page_requests.pop_back();
+			lock.unlock();
+
+			PageResult result;
+			result.offset = request.offset;
+			result.bytes.resize(request.length);
+			try {
+				prepare();
+				decode(request.offset, result.bytes.data(), request.length);
+			}
+			catch (const std::exception& e) {
+				result.error = e.what();
+			}
+
+			lock.lock();
+			if (page_results.size() >= MAX_PAGE_RESULTS) {
+				page_results.pop_front();
+			}
+			page_results.push_back(std::move(result));
+		}
+	}
+
+	// Uncompressed entries: skip the CRC word at the end of every chunk
+	void readPayload(uint64_t offset, uint8_t* buffer, size_t length) {
+		if (entry.size <= 4) {
+			dat_file.readRaw(entry.offset + offset, buffer, length);
+			return;
+		}
+		const uint64_t payload_per_chunk = CHUNK_SIZE - 4;
+		while (length != 0) {
+			uint64_t within = offset % payload_per_chunk;
+			size_t piece = static_cast<size_t>(std::min<uint64_t>(length, payload_per_chunk - within));
+			dat_file.readRaw(entry.offset + offset / payload_per_chunk * CHUNK_SIZE + within, buffer, piece);
+			buffer += piece;
+			offset += piece;
+			length -= piece;
+		}
+	}
+
+	// Decodes [offset, offset + length) from the nearest checkpoint, into buffer unless it is
+	// null, recording the checkpoints passed on the way
+	void decode(uint64_t offset, uint8_t* buffer, size_t length) {
+		Checkpoint start;
+		uint64_t position;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			size_t index = static_cast<size_t>(std::min<uint64_t>(offset / interval, checkpoints.size() - 1));
+			start = checkpoints[index];
+			position = index * interval;
+		}
+
+		DatDecompressor decompressor;
+		if (start.state.block_remaining != 0) {
+			DatBitReader tree_reader(raw.data, raw.size, start.state.tree_position);
+			decompressor.restoreTrees(tree_reader);
+		}
+		DatBitReader reader(raw.data, raw.size, start.position);
+		DatDecompressor::State state = start.state;
+
+		// Output is decoded one interval at a time behind up to WINDOW_SIZE bytes of history
+		std::vector<uint8_t> work(static_cast<size_t>(WINDOW_SIZE + interval));
+		uint8_t* out = work.data() + WINDOW_SIZE;
+		size_t history = start.window.size();
+		std::copy(start.window.begin(), start.window.end(), out - history);
+
+		const uint64_t end = offset + length;
+		while (position < end && !state.finished) {
+			if (cancelled) {
+				throw std::runtime_error("Cancelled");
+			}
+
+			// A read stops where its range does; only whole intervals end at a checkpoint
+			uint64_t want = std::min(interval, end - position);
+			uint8_t* out_end = decompressor.decode(reader, state, out - history, out, out + want);
+			size_t produced = static_cast<size_t>(out_end - out);
+			if (produced == 0) {
+				break;
+			}
+
+			uint64_t copy_begin = std::max(offset, position);
+			uint64_t copy_end = std::min(end, position + produced);
+			if (buffer && copy_begin < copy_end) {
+				std::memcpy(buffer + (copy_begin - offset), out + (copy_begin - position), static_cast<size_t>(copy_end - copy_begin));
+			}
+			position += produced;
+
+			size_t kept = std::min(static_cast<size_t>(WINDOW_SIZE), history + produced);
+			if (!state.finished && produced == interval) {
+				Checkpoint next;
+				next.position = reader.getPosition();
+				next.state = state;
+				next.window.assign(out_end - kept, out_end);
+				record(static_cast<size_t>(position / interval), std::move(next));
+			}
+
+			std::memmove(out - kept, out_end - kept, kept);
+			history = kept;
+		}
+
+		if (position < end) {
+			throw std::runtime_error("Compressed stream of entry " + std::to_string(mft_index) + " ended early");
+		}
+		if (state.finished) {
+			std::lock_guard<std::mutex> lock(mutex);
+			indexed = true;
+		}
+	}
+
+	void record(size_t index, Checkpoint&& checkpoint) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (index == checkpoints.size()) {
+				checkpoints.push_back(std::move(checkpoint));
+			}
+		}
+		condition.notify_all();
+	}
+
+	template <typename T>
+	static void append(std::vector<uint8_t>& file, T value) {
+		size_t position = file.size();
+		file.resize(position + sizeof(T));
+		std::memcpy(file.data() + position, &value, sizeof(T));
+	}
+
+	template <typename T>
+	static bool take(ByteSpan file, size_t& position, T& value) {
+		if (file.size - position < sizeof(T)) {
+			return false;
+		}
+		std::memcpy(&value, file.data + position, sizeof(T));
+		position += sizeof(T);
+		return true;
+	}
+
+	static void appendPosition(std::vector<uint8_t>& file, const DatBitReader::Position& position) {
+		append<uint64_t>(file, position.word_position);
+		append<uint64_t>(file, position.crc_word_position);
+		append<uint64_t>(file, position.bit_buffer);
+		append<uint32_t>(file, position.bit_count);
+	}
+
+	static bool takePosition(ByteSpan file, size_t& position, DatBitReader::Position& value) {
+		return take(file, position, value.word_position) && take(file, position, value.crc_word_position) &&
+			take(file, position, value.bit_buffer) && take(file, position, value.bit_count);
+	}
+
+	// Called with the mutex held
+	std::vector<uint8_t> serialize() const {
+		std::vector<uint8_t> file(HEADER_SIZE);
+		for (const Checkpoint& checkpoint : checkpoints) {
+			appendPosition(file, checkpoint.position);
+			append<uint64_t>(file, checkpoint.state.remaining_output);
+			append<uint32_t>(file, checkpoint.state.copy_length_bias);
+			append<uint32_t>(file, checkpoint.state.block_remaining);
+			append<uint32_t>(file, checkpoint.state.pending_copy_offset);
+			append<uint64_t>(file, checkpoint.state.pending_copy_length);
+			appendPosition(file, checkpoint.state.tree_position);
+			append<uint32_t>(file, static_cast<uint32_t>(checkpoint.window.size()));
+			file.insert(file.end(), checkpoint.window.begin(), checkpoint.window.end());
+		}
+
+		DatCache::Key key = dat_file.cacheKey();
+		uint8_t* header = file.data();
+		storeField<uint32_t>(header, 0, MAGIC);
+		storeField<uint32_t>(header, 4, FORMAT_VERSION);
+		storeField<uint32_t>(header, 8, key.header_crc);
+		storeField<uint32_t>(header, 12, Crc32c::compute(file.data() + HEADER_SIZE, file.size() - HEADER_SIZE));
+		storeField<uint64_t>(header, 16, key.mft_offset);
+		storeField<uint64_t>(header, 24, key.file_size);
+		storeField<int64_t>(header, 32, key.modification_time);
+		storeField<uint64_t>(header, 40, entry.offset);
+		storeField<uint32_t>(header, 48, entry.size);
+		storeField<uint32_t>(header, 52, static_cast<uint32_t>(checkpoints.size()));
+		storeField<uint64_t>(header, 56, interval);
+		storeField<uint64_t>(header, 64, size);
+		storeField<uint32_t>(header, 72, indexed ? FLAG_INDEXED : 0);
+		return file;
+	}
+
+	// Moves a sidecar to the recent end for trimSidecars
+	static void markUsed(const std::string& path) {
+#ifdef _WIN32
+		_utime(path.c_str(), nullptr);
+#else
+		utime(path.c_str(), nullptr);
+#endif
+	}
+
+	// Replaces the checkpoints with the sidecar's when it belongs to this entry and archive
+	bool loadCheckpoints() {
+		std::ifstream input(sidecar_path, std::ios::binary | std::ios::ate);
+		if (!input) {
+			return false;
+		}
+		std::vector<uint8_t> bytes(static_cast<size_t>(input.tellg()));
+		input.seekg(0);
+		if (!input.read(reinterpret_cast<char*>(bytes.data()), bytes.size()) || bytes.size() < HEADER_SIZE) {
+			return false;
+		}
+
+		ByteSpan file(bytes.data(), bytes.size());
+		DatCache::Key key = dat_file.cacheKey();
+		DatCache::Key stored_key;
+		stored_key.header_crc = loadField<uint32_t>(file.data, 8);
+		stored_key.mft_offset = loadField<uint64_t>(file.data, 16);
+		stored_key.file_size = loadField<uint64_t>(file.data, 24);
+		stored_key.modification_time = loadField<int64_t>(file.data, 32);
+		uint32_t count = loadField<uint32_t>(file.data, 52);
+		if (loadField<uint32_t>(file.data, 0) != MAGIC || loadField<uint32_t>(file.data, 4) != FORMAT_VERSION ||
+			!(stored_key == key) || loadField<uint64_t>(file.data, 40) != entry.offset ||
+			loadField<uint32_t>(file.data, 48) != entry.size || loadField<uint64_t>(file.data, 56) != interval ||
+			loadField<uint64_t>(file.data, 64) != size || count == 0 ||
+			Crc32c::compute(file.data + HEADER_SIZE, file.size - HEADER_SIZE) != loadField<uint32_t>(file.data, 12)) {
+			return false;
+		}
+
+		std::vector<Checkpoint> loaded(count);
+		size_t position = HEADER_SIZE;
+		for (Checkpoint& checkpoint : loaded) {
+			uint64_t pending_copy_length;
+			uint32_t window_size;
+			if (!takePosition(file, position, checkpoint.position) || !take(file, position, checkpoint.state.remaining_output) ||
+				!take(file, position, checkpoint.state.copy_length_bias) || !take(file, position, checkpoint.state.block_remaining) ||
+				!take(file, position, checkpoint.state.pending_copy_offset) || !take(file, position, pending_copy_length) ||
+				!takePosition(file, position, checkpoint.state.tree_position) || !take(file, position, window_size) ||
+				window_size > WINDOW_SIZE || file.size - position < window_size) {
+				return false;
+			}
+			checkpoint.state.pending_copy_length = static_cast<size_t>(pending_copy_length);
+			checkpoint.window.assign(file.data + position, file.data + position + window_size);
+			position += window_size;
+		}
+
+		input.close();
+		markUsed(sidecar_path);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		checkpoints = std::move(loaded);
+		indexed = (loadField<uint32_t>(file.data, 72) & FLAG_INDEXED) != 0;
+		return true;
+	}
+};
+
+#endif // !DAT_SEEKABLE_ENTRY_H
@@ -0,0 +1,356 @@
+#ifndef DAT_VERIFIER_H
+#define DAT_VERIFIER_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+#include "DatFile.h"
+#include "DatReadScheduler.h"
+#include "ThreadPool.h"
+
+// Whole-archive integrity check of every entry's chunk CRC32C words. The per-entry crc field
+// of the MFT is not checked, what it covers is not known.
+//
+// Entries are walked in archive offset order so the archive is read front to back, and handed
+// to a thread pool in batches of roughly BATCH_BYTES so hundreds of thousands of small entries
+// do not each pay for a task. Within a batch, entries that sit next to each other are read
+// together (see DatReadScheduler). In Mapped mode workers checksum straight from the mapping.
+// In Stream mode workers read their own batches with positional reads. With use_io_uring on
+// Linux this thread instead reads each batch into a UringReader buffer with one deep io_uring
+// queue and workers only checksum it; it is off by default because it has yet to beat
+// positional reads in `bench --stream`. Either way the raw bytes in flight are capped by a
+// memory budget.
+class DatVerifier {
+public:
+	static constexpr uint64_t BATCH_BYTES = 8ull << 20;
+
+	struct Options {
+		size_t thread_count = 0;               // 0 = one per hardware thread
+		uint64_t memory_budget = 256ull << 20; // raw bytes in flight, Stream mode only
+		bool use_io_uring = false;             // Stream mode only, falls back when unavailable
+	};
+
+	struct Progress {
+		uint64_t entries_total = 0;
+		uint64_t bytes_total = 0;
+		std::atomic<uint64_t> entries_done{ 0 };
+		std::atomic<uint64_t> entries_corrupt{ 0 };
+		std::atomic<uint64_t> entries_failed{ 0 }; // could not be read at all
+		std::atomic<uint64_t> bytes_read{ 0 };
+	};
+
+	struct Failure {
+		uint32_t mft_index;
+		uint64_t offset;      // archive offset of the bad chunk, or of the entry when unreadable
+		bool corrupt;         // false when the entry could not be read
+		std::string message;
+	};
+
+	typedef std::function<void(const Progress&)> ProgressCallback;
+
+	DatVerifier(DatFile& dat_file, const Options& options) : dat_file(dat_file), options(options),
+		in_flight_bytes(0), cancelled(false) {
+	}
+
+	// Verifies all entries, calling callback from this thread roughly every progress_interval.
+	// Failures are sorted by MFT index afterwards.
+	void run(const ProgressCallback& callback = nullptr,
+		std::chrono::milliseconds progress_interval = std::chrono::milliseconds(250)) {
+		const auto& mft_data = dat_file.getMftData();
+
+		std::vector<uint32_t> order;
+		order.reserve(mft_data.size());
+		for (uint32_t i = 0; i < mft_data.size(); ++i) {
+			if (mft_data[i].size != 0 && !isArchiveTable(i)) {
+				order.push_back(i);
+				progress.bytes_total += mft_data[i].size;
+			}
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return mft_data[a].offset < mft_data[b].offset;
+		});
+		progress.entries_total = order.size();
+
+		auto last_report = std::chrono::steady_clock::now();
+		auto report = [&](bool force) {
+			auto now = std::chrono::steady_clock::now();
+			if (callback && (force || now - last_report >= progress_interval)) {
+				callback(progress);
+				last_report = now;
+			}
+		};
+
+		// Declared before the pool, whose workers read the reader's buffers. One buffer per worker
+		// plus two being read keeps both busy, more would only pin memory.
+		std::unique_ptr<UringReader> reader;
+		BatchBuffers buffers;
+		ThreadPool pool(options.thread_count);
+		if (options.use_io_uring) {
+			uint64_t buffer_count = std::min<uint64_t>(pool.size() + 2, std::max<uint64_t>(2, options.memory_budget / BATCH_BYTES));
+			reader = dat_file.createUringReader(static_cast<size_t>(buffer_count), BATCH_BYTES);
+		}
+		if (reader) {
+			buffers.batches.resize(reader->getBufferCount());
+			buffers.scheduler.reset(new DatReadScheduler(dat_file, uringRuns()));
+			for (size_t i = 0; i < reader->getBufferCount(); ++i) {
+				buffers.free.push_back(i);
+			}
+		}
+
+		size_t batch_start = 0;
+		while (batch_start < order.size() && !cancelled) {
+			size_t batch_end = batch_start;
+			uint64_t batch_bytes = 0;
+			while (batch_end < order.size() && (batch_end == batch_start || batch_bytes < BATCH_BYTES)) {
+				uint64_t entry_size = mft_data[order[batch_end]].size;
+				// io_uring batches have to fit one reader buffer
+				if (reader && batch_end != batch_start && batch_bytes + entry_size > BATCH_BYTES) {
+					break;
+				}
+				batch_bytes += entry_size;
+				++batch_end;
+			}
+
+			if (reader && batch_bytes <= BATCH_BYTES) {
+				size_t buffer_index = acquireBuffer(*reader, buffers, pool, report);
+				BufferBatch& batch = buffers.batches[buffer_index];
+				batch.entries.assign(order.begin() + batch_start, order.begin() + batch_end);
+				batch.runs = buffers.scheduler->plan(batch.entries);
+				std::vector<UringReader::Range> ranges;
+				ranges.reserve(batch.runs.size());
+				for (const DatReadScheduler::Run& run : batch.runs) {
+					ranges.push_back({ run.offset, static_cast<size_t>(run.size) });
+				}
+				reader->submit(buffer_index, ranges.data(), ranges.size());
+				batch_start = batch_end;
+				report(false);
+				continue;
+			}
+
+			uint64_t charge = dat_file.isMapped() ? 0 : batch_bytes;
+			acquireBudget(charge, report);
+			pool.submit([this, &order, batch_start, batch_end, charge] {
+				DatReadScheduler scheduler(dat_file);
+				scheduler.read(std::vector<uint32_t>(order.begin() + batch_start, order.begin() + batch_end),
+					[this](uint32_t mft_index, ByteSpan raw_span) {
+						if (!cancelled) {
+							checkEntry(mft_index, raw_span);
+						}
+					},
+					[this](uint32_t mft_index, const std::exception& e) {
+						addUnreadable(mft_index, e);
+					});
+				releaseBudget(charge);
+			});
+			batch_start = batch_end;
+			report(false);
+		}
+
+		while (reader && reader->pendingCount() != 0) {
+			dispatchBatch(*reader, buffers, pool);
+		}
+
+		// Keep reporting while the pool drains
+		while (true) {
+			std::unique_lock<std::mutex> lock(budget_mutex);
+			if (budget_condition.wait_for(lock, progress_interval, [this] { return running_batches == 0; })) {
+				break;
+			}
+			lock.unlock();
+			report(false);
+		}
+		pool.wait();
+
+		std::sort(failures.begin(), failures.end(), [](const Failure& a, const Failure& b) {
+			return a.mft_index < b.mft_index;
+		});
+		report(true);
+	}
+
+	// Stops scheduling and checking entries; checks already running still finish
+	void cancel() {
+		cancelled = true;
+	}
+
+	const Progress& getProgress() const {
+		return progress;
+	}
+
+	const std::vector<Failure>& getFailures() const {
+		return failures;
+	}
+
+private:
+	DatFile& dat_file;
+	Options options;
+	Progress progress;
+	std::vector<Failure> failures;
+	std::mutex failure_mutex;
+	std::mutex budget_mutex;
+	std::condition_variable budget_condition;
+	uint64_t in_flight_bytes;
+	uint64_t running_batches = 0;
+	std::atomic<bool> cancelled;
+
+	// The archive header, MFT and index table are listed in the MFT but carry no chunk CRCs
+	bool isArchiveTable(uint32_t mft_index) const {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+		return mft_index == MFT_ENTRY_INDEX_NUM || entry.offset == dat_file.getHeader().mft_offset ||
+			entry.offset < DAT_HEADER_SIZE;
+	}
+
+	// Entries in a reader buffer, in offset order, and the runs they were read as, back to back
+	struct BufferBatch {
+		std::vector<uint32_t> entries;
+		std::vector<DatReadScheduler::Run> runs;
+	};
+
+	// Reader buffers not holding a batch, guarded by budget_mutex, and each buffer's batch
+	struct BatchBuffers {
+		std::vector<size_t> free;
+		std::vector<BufferBatch> batches;
+		std::unique_ptr<DatReadScheduler> scheduler; // plans only, used by this thread
+	};
+
+	// Only touching entries are merged for io_uring batches, so a batch's runs never take more
+	// room in the buffer than its entries
+	static DatReadScheduler::Options uringRuns() {
+		DatReadScheduler::Options run_options;
+		run_options.max_gap = 0;
+		run_options.max_read = BATCH_BYTES;
+		return run_options;
+	}
+
+	// A free reader buffer, handing read batches to the pool until one is
+	template <typename Report>
+	size_t acquireBuffer(UringReader& reader, BatchBuffers& buffers, ThreadPool& pool, Report& report) {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(budget_mutex);
+				if (!buffers.free.empty()) {
+					size_t buffer_index = buffers.free.back();
+					buffers.free.pop_back();
+					++running_batches;
+					return buffer_index;
+				}
+				if (reader.pendingCount() == 0) {
+					// Every buffer is being checked, wait for a worker to give one back
+					budget_condition.wait_for(lock, std::chrono::milliseconds(50));
+					lock.unlock();
+					report(false);
+					continue;
+				}
+			}
+			dispatchBatch(reader, buffers, pool);
+		}
+	}
+
+	// Waits for the next batch read in full and has a worker check it
+	void dispatchBatch(UringReader& reader, BatchBuffers& buffers, ThreadPool& pool) {
+		bool ok;
+		size_t buffer_index = reader.wait(ok);
+		const uint8_t* data = reader.getBuffer(buffer_index);
+		pool.submit([this, &buffers, buffer_index, data, ok] {
+			const auto& mft_data = dat_file.getMftData();
+			const BufferBatch& batch = buffers.batches[buffer_index];
+			uint64_t position = 0;
+			for (const DatReadScheduler::Run& run : batch.runs) {
+				for (size_t i = run.begin; i < run.end && !cancelled; ++i) {
+					const DatFile::MftData& entry = mft_data[batch.entries[i]];
+					if (ok) {
+						checkEntry(batch.entries[i], ByteSpan(data + position + (entry.offset - run.offset), entry.size));
+					}
+					else {
+						// Read again on its own for an error naming the entry
+						verifyEntry(batch.entries[i]);
+					}
+				}
+				position += run.size;
+			}
+			{
+				std::lock_guard<std::mutex> lock(budget_mutex);
+				buffers.free.push_back(buffer_index);
+				--running_batches;
+			}
+			budget_condition.notify_all();
+		});
+	}
+
+	template <typename Report>
+	void acquireBudget(uint64_t charge, Report& report) {
+		std::unique_lock<std::mutex> lock(budget_mutex);
+		// A batch larger than the whole budget still runs, just on its own
+		while (in_flight_bytes != 0 && in_flight_bytes + charge > options.memory_budget) {
+			budget_condition.wait_for(lock, std::chrono::milliseconds(50));
+			lock.unlock();
+			report(false);
+			lock.lock();
+		}
+		in_flight_bytes += charge;
+		++running_batches;
+	}
+
+	void releaseBudget(uint64_t charge) {
+		{
+			std::lock_guard<std::mutex> lock(budget_mutex);
+			in_flight_bytes -= charge;
+			--running_batches;
+		}
+		budget_condition.notify_all();
+	}
+
+	void addFailure(const Failure& failure) {
+		std::lock_guard<std::mutex> lock(failure_mutex);
+		failures.push_back(failure);
+	}
+
+	void verifyEntry(uint32_t mft_index) {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+
+		try {
+			std::vector<uint8_t> raw_data;
+			ByteSpan raw_span;
+			if (dat_file.isMapped()) {
+				raw_span = dat_file.getEntrySpan(entry);
+			}
+			else {
+				raw_data = dat_file.readCompressedData(entry);
+				raw_span = ByteSpan(raw_data.data(), raw_data.size());
+			}
+			checkEntry(mft_index, raw_span);
+		}
+		catch (const std::exception& e) {
+			addUnreadable(mft_index, e);
+		}
+	}
+
+	void addUnreadable(uint32_t mft_index, const std::exception& error) {
+		progress.entries_failed++;
+		addFailure({ mft_index, dat_file.getMftData()[mft_index].offset, false, error.what() });
+	}
+
+	void checkEntry(uint32_t mft_index, ByteSpan raw_span) {
+		const DatFile::MftData& entry = dat_file.getMftData()[mft_index];
+		progress.bytes_read += entry.size;
+
+		int64_t corrupt_chunk = DatFile::findCorruptChunk(raw_span);
+		if (corrupt_chunk < 0) {
+			progress.entries_done++;
+			return;
+		}
+
+		progress.entries_corrupt++;
+		uint64_t chunk_offset = static_cast<uint64_t>(corrupt_chunk) * CHUNK_SIZE;
+		addFailure({ mft_index, entry.offset + chunk_offset, true,
+			"CRC32C mismatch in chunk " + std::to_string(corrupt_chunk) + " at entry offset " + std::to_string(chunk_offset) });
+	}
+};
+
+#endif // !DAT_VERIFIER_H
@@ -0,0 +1,187 @@
+#ifndef DAT_WRITER_H
+#define DAT_WRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "DatFile.h"
+#include "DatCompress.h"
+#include "Crc32c.h"
+
+// Writes archives in the Gw2.dat layout DatFile reads, for benchmark fixtures and test data.
+//
+// Entries are streamed to disk as they are added, split into CHUNK_SIZE chunks that each end
+// in the CRC32C of their payload. finish() appends the index table and the MFT and then fills
+// in the DAT header. Only the packed table rows are held in memory, 24 bytes per entry plus 8
+// per file id, so archives of millions of entries and tens of GB can be written.
+//
+// MFT slot 0 is the MFT's own entry and MFT_ENTRY_INDEX_NUM the index table, as in real
+// archives; added entries follow. The index table maps each file_id to a base_id equal to the
+// MFT index of its entry; an entry can have several file ids.
+class DatWriter {
+public:
+	// compression_flag DatFile sees on compressed entries
+	static constexpr uint16_t COMPRESSED_FLAG = 8;
+	static constexpr uint32_t FIRST_ENTRY_INDEX = MFT_ENTRY_INDEX_NUM + 1;
+
+	explicit DatWriter(const std::string& file_path) : file_path(file_path), finished(false) {
+		output.rdbuf()->pubsetbuf(output_buffer.data(), output_buffer.size());
+		output.open(file_path, std::ios::binary | std::ios::trunc);
+		if (!output) {
+			throw std::runtime_error("Failed to create file: " + file_path);
+		}
+
+		// Placeholder, rewritten by finish()
+		const uint8_t header[DAT_HEADER_SIZE] = {};
+		write(header, DAT_HEADER_SIZE);
+
+		mft_table.resize(FIRST_ENTRY_INDEX * MFT_ENTRY_SIZE);
+	}
+
+	DatWriter(const DatWriter&) = delete;
+	DatWriter& operator=(const DatWriter&) = delete;
+
+	// Appends an entry, compressed with DatCompressor when compress is set, and returns its
+	// MFT index. file_id is recorded in the index table; 0 leaves the entry out of it.
+	uint32_t addEntry(const uint8_t* data, size_t size, bool compress, uint32_t file_id = 0) {
+		if (compress) {
+			std::vector<uint8_t> compressed = compressor.compress(data, size);
+			return addRawEntry(compressed.data(), compressed.size(), COMPRESSED_FLAG, file_id);
+		}
+		return addRawEntry(data, size, 0, file_id);
+	}
+
+	// Appends a payload as is, e.g. one already in the compressed word format
+	uint32_t addRawEntry(const uint8_t* payload, size_t size, uint16_t compression_flag, uint32_t file_id = 0) {
+		if (finished) {
+			throw std::logic_error("DatWriter::addRawEntry called after finish");
+		}
+
+		uint64_t chunk_count = (static_cast<uint64_t>(size) + CHUNK_SIZE - 5) / (CHUNK_SIZE - 4);
+		if (size + chunk_count * 4 > UINT32_MAX) {
+			throw std::length_error("Entry too large for the 32-bit MFT size field: " + std::to_string(size) + " bytes");
+		}
+
+		uint64_t offset = position;
+		uint32_t raw_size = static_cast<uint32_t>(writeChunked(payload, size));
+
+		uint32_t mft_index = static_cast<uint32_t>(getEntryCount());
+		mft_table.resize(mft_table.size() + MFT_ENTRY_SIZE);
+		storeEntry(mft_index, offset, raw_size, compression_flag);
+		if (file_id != 0) {
+			addFileId(mft_index, file_id);
+		}
+		return mft_index;
+	}
+
+	// Records another file_id resolving to the entry at mft_index
+	void addFileId(uint32_t mft_index, uint32_t file_id) {
+		DatFile::MftIndexData index_entry;
+		index_entry.file_id = file_id;
+		index_entry.base_id = mft_index;
+		index_table.push_back(index_entry);
+	}
+
+	size_t getEntryCount() const {
+		return mft_table.size() / MFT_ENTRY_SIZE;
+	}
+
+	uint64_t getBytesWritten() const {
+		return position;
+	}
+
+	// Writes the index table, the MFT and the header, then closes the file
+	void finish() {
+		if (finished) {
+			return;
+		}
+		finished = true;
+
+		// Sorted by file_id like the tables in shipped archives
+		std::sort(index_table.begin(), index_table.end(), [](const DatFile::MftIndexData& a, const DatFile::MftIndexData& b) {
+			return a.file_id < b.file_id;
+		});
+		static_assert(sizeof(DatFile::MftIndexData) == MFT_INDEX_ENTRY_SIZE, "MftIndexData must match the on-disk layout");
+		uint32_t index_size = static_cast<uint32_t>(index_table.size() * MFT_INDEX_ENTRY_SIZE);
+		storeEntry(MFT_ENTRY_INDEX_NUM, position, index_size, 0);
+		write(index_table.data(), index_size);
+
+		// The header takes the first slot of the table
+		uint64_t mft_offset = position;
+		uint32_t slot_count = static_cast<uint32_t>(getEntryCount() + 1);
+		uint32_t mft_size = slot_count * static_cast<uint32_t>(MFT_ENTRY_SIZE);
+		storeEntry(0, mft_offset, mft_size, 0);
+
+		uint8_t mft_header[MFT_HEADER_SIZE] = {};
+		std::memcpy(mft_header, "Mft\x1a", MFT_MAGIC_NUMBER);
+		storeField<uint32_t>(mft_header, 12, slot_count);
+		write(mft_header, MFT_HEADER_SIZE);
+		write(mft_table.data(), mft_table.size());
+
+		uint8_t header[DAT_HEADER_SIZE] = {};
+		header[0] = DAT_VERSION;
+		std::memcpy(header + 1, "AN\x1a", DAT_MAGIC_NUMBER);
+		storeField<uint32_t>(header, 4, static_cast<uint32_t>(DAT_HEADER_SIZE));
+		storeField<uint32_t>(header, 12, static_cast<uint32_t>(CHUNK_SIZE));
+		storeField<uint64_t>(header, 24, mft_offset);
+		storeField<uint32_t>(header, 32, mft_size);
+		output.seekp(0);
+		output.write(reinterpret_cast<const char*>(header), DAT_HEADER_SIZE);
+
+		output.close();
+		if (!output) {
+			throw std::runtime_error("Failed to write file: " + file_path);
+		}
+	}
+
+private:
+	static constexpr uint8_t DAT_VERSION = 0x61;
+
+	std::string file_path;
+	std::vector<char> output_buffer = std::vector<char>(1 << 20);
+	std::ofstream output;
+	uint64_t position = 0;
+	std::vector<uint8_t> mft_table; // packed MFT rows, one per slot after the header
+	std::vector<DatFile::MftIndexData> index_table;
+	DatCompressor compressor;
+	bool finished;
+
+	void storeEntry(uint32_t mft_index, uint64_t offset, uint32_t size, uint16_t compression_flag) {
+		uint8_t* record = &mft_table[static_cast<size_t>(mft_index) * MFT_ENTRY_SIZE];
+		std::memset(record, 0, MFT_ENTRY_SIZE);
+		storeField<uint64_t>(record, 0, offset);
+		storeField<uint32_t>(record, 8, size);
+		storeField<uint16_t>(record, 12, compression_flag);
+	}
+
+	void write(const void* data, size_t size) {
+		output.write(reinterpret_cast<const char*>(data), size);
+		if (!output) {
+			throw std::runtime_error("Failed to write file: " + file_path);
+		}
+		position += size;
+	}
+
+	// Payload in chunks of CHUNK_SIZE - 4 bytes, each followed by its CRC32C word; returns the
+	// bytes written. Empty payloads are stored as empty entries without a CRC word.
+	size_t writeChunked(const uint8_t* payload, size_t size) {
+		const size_t payload_per_chunk = CHUNK_SIZE - 4;
+		size_t written = 0;
+		for (size_t chunk_start = 0; chunk_start < size; chunk_start += payload_per_chunk) {
+			size_t chunk_size = std::min(payload_per_chunk, size - chunk_start);
+			uint8_t crc_word[4];
+			storeField<uint32_t>(crc_word, 0, Crc32c::compute(payload + chunk_start, chunk_size));
+			write(payload + chunk_start, chunk_size);
+			write(crc_word, sizeof(crc_word));
+			written += chunk_size + sizeof(crc_word);
+		}
+		return written;
+	}
+};
+
+#endif // !DAT_WRITER_H
@@ -0,0 +1,120 @@
+#ifndef ENTRY_CACHE_H
+#define ENTRY_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Least recently used cache of decoded entry buffers, keyed by MFT index.
+//
+// The bytes held are capped by a budget; inserting past it evicts from the cold end. Buffers
+// are shared, so an evicted entry stays alive for as long as a tab still displays it.
+// Safe to use from several threads.
+class EntryCache {
+public:
+	typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		uint64_t bytes = 0;
+		size_t entries = 0;
+		uint64_t byte_budget = 0;
+	};
+
+	explicit EntryCache(uint64_t byte_budget) : byte_budget(byte_budget), cached_bytes(0),
+		hits(0), misses(0), evictions(0) {
+	}
+
+	// Returns null on a miss
+	Data find(uint32_t mft_index) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = positions.find(mft_index);
+		if (it == positions.end()) {
+			++misses;
+			return nullptr;
+		}
+		++hits;
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->data;
+	}
+
+	void insert(uint32_t mft_index, const Data& data) {
+		if (!data) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = positions.find(mft_index);
+		if (it != positions.end()) {
+			cached_bytes -= it->second->data->size();
+			entries.erase(it->second);
+			positions.erase(it);
+		}
+
+		// A buffer bigger than the whole budget would only flush everything else
+		if (data->size() > byte_budget) {
+			return;
+		}
+
+		entries.push_front({ mft_index, data });
+		positions[mft_index] = entries.begin();
+		cached_bytes += data->size();
+		evictToBudget();
+	}
+
+	void setByteBudget(uint64_t new_budget) {
+		std::lock_guard<std::mutex> lock(mutex);
+		byte_budget = new_budget;
+		evictToBudget();
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		positions.clear();
+		cached_bytes = 0;
+	}
+
+	Stats getStats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats stats;
+		stats.hits = hits;
+		stats.misses = misses;
+		stats.evictions = evictions;
+		stats.bytes = cached_bytes;
+		stats.entries = entries.size();
+		stats.byte_budget = byte_budget;
+		return stats;
+	}
+
+private:
+	struct Node {
+		uint32_t mft_index;
+		Data data;
+	};
+
+	mutable std::mutex mutex;
+	std::list<Node> entries; // most recently used first
+	std::unordered_map<uint32_t, std::list<Node>::iterator> positions;
+	uint64_t byte_budget;
+	uint64_t cached_bytes;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+
+	void evictToBudget() {
+		while (cached_bytes > byte_budget && !entries.empty()) {
+			cached_bytes -= entries.back().data->size();
+			positions.erase(entries.back().mft_index);
+			entries.pop_back();
+			++evictions;
+		}
+	}
+};
+
+#endif // !ENTRY_CACHE_H
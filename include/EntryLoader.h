@@ -0,0 +1,202 @@
+#ifndef ENTRY_LOADER_H
+#define ENTRY_LOADER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+
+#include "DatFile.h"
+#include "EntryCache.h"
+
+// Background loader for the entries shown by the viewer.
+//
+// The UI thread queues requests and polls the returned futures once per frame, so reading and
+// decompressing a large entry never stalls rendering. When the selection moves on, requests
+// still waiting in the queue are cancelled; a request already being decoded finishes and its
+// result is simply not picked up. Decompressed entries go through an LRU cache, so flipping
+// back to a recently viewed entry resolves immediately without a round trip to the worker.
+class EntryLoader {
+public:
+	enum class Kind {
+		Compressed,  // raw entry bytes, chunk CRC words included
+		Decompressed, // CRC words stripped and, for compressed entries, inflated
+		ChunkCrcs     // stored chunk CRC words, once every chunk has been checked against them
+	};
+
+	struct Result {
+		std::shared_ptr<const std::vector<uint8_t>> data; // null if the load failed or was cancelled
+		std::string error;
+	};
+
+	// Handle kept by a tab for the entry it displays
+	class Request {
+	public:
+		Request() : mft_index(0), kind(Kind::Compressed) {}
+
+		bool valid() const {
+			return future.valid();
+		}
+
+		bool isFor(uint32_t index, Kind request_kind) const {
+			return valid() && mft_index == index && kind == request_kind;
+		}
+
+		// Non-blocking check, meant to be called every frame
+		bool ready() const {
+			return valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		// Only call once ready() returned true, or to block until the load completes
+		const Result& get() const {
+			return future.get();
+		}
+
+		uint32_t getMftIndex() const {
+			return mft_index;
+		}
+
+	private:
+		friend class EntryLoader;
+
+		uint32_t mft_index;
+		Kind kind;
+		std::shared_future<Result> future;
+	};
+
+	explicit EntryLoader(DatFile& dat_file, uint64_t cache_budget = 256ull << 20) : dat_file(dat_file),
+		cache(cache_budget), stopping(false) {
+		worker = std::thread([this] { workerLoop(); });
+	}
+
+	~EntryLoader() {
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			stopping = true;
+		}
+		queue_condition.notify_all();
+		worker.join();
+		cancelPending();
+	}
+
+	EntryLoader(const EntryLoader&) = delete;
+	EntryLoader& operator=(const EntryLoader&) = delete;
+
+	Request request(uint32_t mft_index, Kind kind) {
+		Job job;
+		job.mft_index = mft_index;
+		job.kind = kind;
+
+		Request handle;
+		handle.mft_index = mft_index;
+		handle.kind = kind;
+		handle.future = job.promise.get_future().share();
+
+		if (kind == Kind::Decompressed) {
+			Result cached;
+			cached.data = cache.find(mft_index);
+			if (cached.data) {
+				job.promise.set_value(cached);
+				return handle;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			jobs.push_back(std::move(job));
+		}
+		queue_condition.notify_one();
+		return handle;
+	}
+
+	// Resolves every queued request as cancelled
+	void cancelPending() {
+		std::deque<Job> cancelled;
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			cancelled.swap(jobs);
+		}
+		for (auto& job : cancelled) {
+			Result result;
+			result.error = "Cancelled";
+			job.promise.set_value(result);
+		}
+	}
+
+	size_t pendingCount() const {
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		return jobs.size();
+	}
+
+	EntryCache& getCache() {
+		return cache;
+	}
+
+private:
+	struct Job {
+		uint32_t mft_index;
+		Kind kind;
+		std::promise<Result> promise;
+	};
+
+	DatFile& dat_file;
+	EntryCache cache;
+	std::thread worker;
+	std::deque<Job> jobs;
+	mutable std::mutex queue_mutex;
+	std::condition_variable queue_condition;
+	bool stopping;
+
+	void workerLoop() {
+		while (true) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(queue_mutex);
+				queue_condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job.promise.set_value(load(job.mft_index, job.kind));
+		}
+	}
+
+	Result load(uint32_t mft_index, Kind kind) {
+		Result result;
+		try {
+			const auto& mft_data = dat_file.getMftData();
+			if (mft_index >= mft_data.size()) {
+				throw std::out_of_range("MFT index out of range: " + std::to_string(mft_index));
+			}
+			const DatFile::MftData& entry = mft_data[mft_index];
+
+			std::vector<uint8_t> data;
+			if (kind == Kind::Compressed) {
+				data = dat_file.readCompressedData(entry);
+			}
+			else if (kind == Kind::ChunkCrcs) {
+				data = dat_file.verifyChunkCrcs(entry);
+			}
+			else {
+				data = dat_file.readDecompressedData(entry);
+			}
+			result.data = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+			if (kind == Kind::Decompressed) {
+				cache.insert(mft_index, result.data);
+			}
+		}
+		catch (const std::exception& e) {
+			result.error = e.what();
+		}
+		return result;
+	}
+};
+
+#endif // !ENTRY_LOADER_H
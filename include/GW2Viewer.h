@@ -15,6 +15,7 @@
 #include <stdexcept>
 #include <memory>
 #include <thread>
+#include <future>
 #include <chrono>
 #include <stdio.h>
 #include <algorithm>
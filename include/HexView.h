@@ -0,0 +1,347 @@
+#ifndef HEX_VIEW_H
+#define HEX_VIEW_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+#include "imgui.h"
+
+// Hex dump viewer: offset, 16 hex bytes, ASCII column.
+//
+// Lines are addressed with 64-bit numbers and scrolled by the view itself rather than by an
+// ImGui child window, whose float scroll position and int clipper cannot address a 70 GiB
+// archive. Only the visible rows are formatted, each straight into a stack buffer from lookup
+// tables, so a frame costs the same whatever the size of the data. The data is either a buffer
+// already in memory or a read function that pages it in on demand, PAGE_SIZE bytes at a time.
+// A read function may answer "not yet": the page shows as "??" and is asked for again on each
+// frame until its bytes arrive, so a slow source never holds up the UI.
+class HexView {
+public:
+	// Copies length bytes at offset into buffer and returns true, or returns false when they are
+	// not available yet; throws on failure
+	typedef std::function<bool(uint64_t offset, uint8_t* buffer, size_t length)> ReadFunction;
+
+	static constexpr int BYTES_PER_LINE = 16;
+	static constexpr size_t PAGE_SIZE = 64 * 1024;
+	static constexpr size_t MAX_PAGES = 8;
+
+	// "XXXXXXXXXXXXXXXX: " + "XX " per byte + " " + one ASCII character per byte
+	static constexpr size_t MAX_LINE_LENGTH = 16 + 2 + BYTES_PER_LINE * 3 + 1 + BYTES_PER_LINE;
+
+	HexView() : data(nullptr), data_size(0), top_line(0), visible_lines(1), highlighted_offset(NO_HIGHLIGHT) {
+		offset_input[0] = '\0';
+	}
+
+	// Shows a buffer that stays alive while it is displayed; the position is kept for as long
+	// as the same buffer is passed in
+	void setBuffer(const uint8_t* buffer, uint64_t size) {
+		if (buffer == data && size == data_size && !read) {
+			return;
+		}
+		reset();
+		data = buffer;
+		data_size = size;
+	}
+
+	// Shows size bytes fetched through read_function as they scroll into view
+	void setSource(uint64_t size, ReadFunction read_function) {
+		reset();
+		data_size = size;
+		read = std::move(read_function);
+	}
+
+	uint64_t getSize() const {
+		return data_size;
+	}
+
+	// Scrolls so the line holding offset is at the top and highlights that byte
+	void jumpTo(uint64_t offset) {
+		if (data_size == 0) {
+			return;
+		}
+		offset = std::min(offset, data_size - 1);
+		top_line = offset / BYTES_PER_LINE;
+		highlighted_offset = offset;
+		clampTopLine();
+	}
+
+	void render(const char* id) {
+		renderJumpInput();
+
+		ImGui::BeginChild(id, ImVec2(0, 0), true, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+		const ImGuiStyle& style = ImGui::GetStyle();
+		ImVec2 available = ImGui::GetContentRegionAvail();
+		float scrollbar_width = style.ScrollbarSize;
+
+		ImGui::BeginChild("Rows", ImVec2(available.x - scrollbar_width - style.ItemSpacing.x, available.y), false,
+			ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+		handleInput();
+		renderRows();
+		ImGui::EndChild();
+
+		ImGui::SameLine();
+		renderScrollbar(ImVec2(scrollbar_width, available.y));
+		ImGui::EndChild();
+	}
+
+	// Formats one line of count (at most BYTES_PER_LINE) bytes into line, which must hold
+	// MAX_LINE_LENGTH characters. Null bytes print as "??". Returns the number of characters
+	// written; no terminator is added.
+	static size_t formatLine(const uint8_t* bytes, int count, uint64_t offset, int offset_digits, char* line) {
+		const Tables& table = tables();
+		char* out = line;
+
+		for (int shift = (offset_digits - 2) * 4; shift >= 0; shift -= 8) {
+			const char* digits = table.hex[(offset >> shift) & 0xFF];
+			*out++ = digits[0];
+			*out++ = digits[1];
+		}
+		*out++ = ':';
+		*out++ = ' ';
+
+		char* ascii = out + BYTES_PER_LINE * 3 + 1;
+		for (int i = 0; i < count; ++i) {
+			const char* digits = bytes ? table.hex[bytes[i]] : "??";
+			out[0] = digits[0];
+			out[1] = digits[1];
+			out[2] = ' ';
+			out += 3;
+			ascii[i] = bytes ? table.ascii[bytes[i]] : '?';
+		}
+		for (int i = count; i < BYTES_PER_LINE; ++i) {
+			out[0] = ' ';
+			out[1] = ' ';
+			out[2] = ' ';
+			out += 3;
+		}
+		*out = ' ';
+
+		// Trailing padding of the ASCII column is left off, it is invisible anyway
+		return static_cast<size_t>(ascii + count - line);
+	}
+
+	// Offsets past 4 GiB get 12 digits instead of 8
+	static int offsetDigits(uint64_t size) {
+		return size > 0xFFFFFFFFull ? 12 : 8;
+	}
+
+private:
+	static constexpr uint64_t NO_HIGHLIGHT = ~0ull;
+
+	struct Page {
+		uint64_t index;
+		std::vector<uint8_t> bytes;
+		bool failed;
+		bool pending; // the read function had no bytes yet, asked again on the next frame
+		uint64_t polled_frame;
+		uint64_t last_used;
+	};
+
+	struct Tables {
+		char hex[256][2];
+		char ascii[256];
+
+		Tables() {
+			static const char digits[] = "0123456789ABCDEF";
+			for (int value = 0; value < 256; ++value) {
+				hex[value][0] = digits[value >> 4];
+				hex[value][1] = digits[value & 0xF];
+				ascii[value] = (value >= 32 && value <= 126) ? static_cast<char>(value) : '.';
+			}
+		}
+	};
+
+	const uint8_t* data;
+	uint64_t data_size;
+	ReadFunction read;
+	std::vector<Page> pages;
+	uint64_t page_clock = 0;
+	uint64_t frame = 0;
+	std::string read_error;
+	uint64_t top_line;
+	uint64_t visible_lines;
+	uint64_t highlighted_offset;
+	char offset_input[17];
+
+	static const Tables& tables() {
+		static const Tables instance;
+		return instance;
+	}
+
+	void reset() {
+		data = nullptr;
+		data_size = 0;
+		read = nullptr;
+		pages.clear();
+		read_error.clear();
+		top_line = 0;
+		highlighted_offset = NO_HIGHLIGHT;
+	}
+
+	uint64_t lineCount() const {
+		return (data_size + BYTES_PER_LINE - 1) / BYTES_PER_LINE;
+	}
+
+	uint64_t maxTopLine() const {
+		uint64_t lines = lineCount();
+		return lines > visible_lines ? lines - visible_lines : 0;
+	}
+
+	void clampTopLine() {
+		top_line = std::min(top_line, maxTopLine());
+	}
+
+	void scrollBy(int64_t lines) {
+		if (lines < 0) {
+			uint64_t up = static_cast<uint64_t>(-lines);
+			top_line = top_line > up ? top_line - up : 0;
+		}
+		else {
+			top_line += static_cast<uint64_t>(lines);
+		}
+		clampTopLine();
+	}
+
+	// Bytes of the line starting at offset, or null if they could not be read. Lines never
+	// straddle pages since PAGE_SIZE is a multiple of BYTES_PER_LINE.
+	const uint8_t* lineBytes(uint64_t offset) {
+		if (data) {
+			return data + offset;
+		}
+
+		uint64_t page_index = offset / PAGE_SIZE;
+		Page* page = nullptr;
+		for (auto& candidate : pages) {
+			if (candidate.index == page_index) {
+				page = &candidate;
+				break;
+			}
+		}
+
+		if (!page) {
+			if (pages.size() < MAX_PAGES) {
+				pages.push_back(Page());
+				page = &pages.back();
+			}
+			else {
+				page = &*std::min_element(pages.begin(), pages.end(),
+					[](const Page& a, const Page& b) { return a.last_used < b.last_used; });
+			}
+
+			uint64_t page_start = page_index * PAGE_SIZE;
+			page->index = page_index;
+			page->bytes.resize(static_cast<size_t>(std::min(static_cast<uint64_t>(PAGE_SIZE), data_size - page_start)));
+			page->failed = false;
+			page->pending = true;
+			page->polled_frame = frame - 1;
+		}
+
+		if (page->pending && page->polled_frame != frame) {
+			page->polled_frame = frame;
+			try {
+				page->pending = !read(page->index * PAGE_SIZE, page->bytes.data(), page->bytes.size());
+			}
+			catch (const std::exception& e) {
+				page->pending = false;
+				page->failed = true;
+				read_error = e.what();
+			}
+		}
+
+		page->last_used = ++page_clock;
+		return page->failed || page->pending ? nullptr : page->bytes.data() + (offset - page->index * PAGE_SIZE);
+	}
+
+	bool anyPagePending() const {
+		return std::any_of(pages.begin(), pages.end(), [](const Page& page) { return page.pending; });
+	}
+
+	void renderJumpInput() {
+		ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 18);
+		bool jump = ImGui::InputTextWithHint("##Offset", "Offset (hex)", offset_input, sizeof(offset_input),
+			ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue);
+		ImGui::SameLine();
+		jump |= ImGui::Button("Go");
+		if (jump && offset_input[0] != '\0') {
+			jumpTo(std::strtoull(offset_input, nullptr, 16));
+		}
+
+		ImGui::SameLine();
+		ImGui::TextDisabled("%llu bytes", static_cast<unsigned long long>(data_size));
+		if (anyPagePending()) {
+			ImGui::SameLine();
+			ImGui::TextDisabled("Loading...");
+		}
+		if (!read_error.empty()) {
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Read failed: %s", read_error.c_str());
+		}
+	}
+
+	void handleInput() {
+		if (ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows)) {
+			float wheel = ImGui::GetIO().MouseWheel;
+			if (wheel != 0.0f) {
+				scrollBy(static_cast<int64_t>(-wheel * 3.0f));
+			}
+		}
+
+		if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && !ImGui::GetIO().WantTextInput) {
+			int64_t page = static_cast<int64_t>(std::max<uint64_t>(1, visible_lines - 1));
+			if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) scrollBy(-1);
+			if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) scrollBy(1);
+			if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) scrollBy(-page);
+			if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) scrollBy(page);
+			if (ImGui::IsKeyPressed(ImGuiKey_Home)) top_line = 0;
+			if (ImGui::IsKeyPressed(ImGuiKey_End)) top_line = maxTopLine();
+		}
+	}
+
+	void renderRows() {
+		++frame;
+		float line_height = ImGui::GetTextLineHeightWithSpacing();
+		visible_lines = std::max<uint64_t>(1, static_cast<uint64_t>(ImGui::GetContentRegionAvail().y / line_height));
+		clampTopLine();
+
+		int offset_digits = offsetDigits(data_size);
+		float character_width = ImGui::CalcTextSize("0").x;
+		uint64_t end_line = std::min(lineCount(), top_line + visible_lines);
+
+		char line[MAX_LINE_LENGTH];
+		for (uint64_t line_number = top_line; line_number < end_line; ++line_number) {
+			uint64_t offset = line_number * BYTES_PER_LINE;
+			int count = static_cast<int>(std::min<uint64_t>(BYTES_PER_LINE, data_size - offset));
+
+			if (highlighted_offset - offset < static_cast<uint64_t>(count)) {
+				int column = static_cast<int>(highlighted_offset - offset);
+				ImVec2 position = ImGui::GetCursorScreenPos();
+				position.x += (offset_digits + 2 + column * 3) * character_width;
+				ImGui::GetWindowDrawList()->AddRectFilled(position,
+					ImVec2(position.x + 2 * character_width, position.y + ImGui::GetTextLineHeight()),
+					ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+			}
+
+			size_t length = formatLine(lineBytes(offset), count, offset, offset_digits, line);
+			ImGui::TextUnformatted(line, line + length);
+		}
+	}
+
+	// The slider runs bottom to top, so it holds the distance from the last line
+	void renderScrollbar(const ImVec2& size) {
+		uint64_t max_top = maxTopLine();
+		uint64_t value = max_top - top_line;
+		const uint64_t min_value = 0;
+		if (ImGui::VSliderScalar("##Scroll", size, ImGuiDataType_U64, &value, &min_value, &max_top, "",
+			ImGuiSliderFlags_AlwaysClamp)) {
+			top_line = max_top - std::min(value, max_top);
+		}
+	}
+};
+
+#endif // !HEX_VIEW_H
@@ -0,0 +1,193 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Non-owning view over a contiguous byte range
+struct ByteSpan {
+	const uint8_t* data;
+	size_t size;
+
+	ByteSpan() : data(nullptr), size(0) {}
+	ByteSpan(const uint8_t* span_data, size_t span_size) : data(span_data), size(span_size) {}
+
+	const uint8_t* begin() const { return data; }
+	const uint8_t* end() const { return data + size; }
+	bool empty() const { return size == 0; }
+	const uint8_t& operator[](size_t index) const { return data[index]; }
+
+	ByteSpan subspan(size_t offset, size_t length) const {
+		if (offset > size) {
+			return ByteSpan();
+		}
+		return ByteSpan(data + offset, std::min(length, size - offset));
+	}
+};
+
+// Fields of on-disk records, which are little-endian and not necessarily aligned
+template <typename T>
+inline T loadField(const uint8_t* record, size_t field_offset) {
+	T value;
+	std::memcpy(&value, record + field_offset, sizeof(T));
+	return value;
+}
+
+template <typename T>
+inline void storeField(uint8_t* record, size_t field_offset, T value) {
+	std::memcpy(record + field_offset, &value, sizeof(T));
+}
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+	MappedFile() : mapped_data(nullptr), mapped_size(0) {}
+
+	~MappedFile() {
+		close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns false when the file cannot be mapped (e.g. exceeds a 32-bit address space)
+	bool open(const std::string& file_path) {
+		close();
+
+#ifdef _WIN32
+		HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0 ||
+			static_cast<uint64_t>(file_size.QuadPart) > static_cast<uint64_t>(SIZE_MAX)) {
+			CloseHandle(file_handle);
+			return false;
+		}
+
+		HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file_handle);
+		if (mapping_handle == nullptr) {
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping_handle);
+		if (view == nullptr) {
+			return false;
+		}
+
+		mapped_data = static_cast<const uint8_t*>(view);
+		mapped_size = static_cast<size_t>(file_size.QuadPart);
+#else
+		int fd = ::open(file_path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat file_stat;
+		if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0 ||
+			static_cast<uint64_t>(file_stat.st_size) > static_cast<uint64_t>(SIZE_MAX)) {
+			::close(fd);
+			return false;
+		}
+
+		size_t size = static_cast<size_t>(file_stat.st_size);
+		void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (view == MAP_FAILED) {
+			return false;
+		}
+
+		// Browsing jumps around the archive, so don't let the kernel read ahead blindly
+		madvise(view, size, MADV_RANDOM);
+
+		mapped_data = static_cast<const uint8_t*>(view);
+		mapped_size = size;
+#endif
+		return true;
+	}
+
+	void close() {
+		if (mapped_data == nullptr) {
+			return;
+		}
+
+#ifdef _WIN32
+		UnmapViewOfFile(mapped_data);
+#else
+		munmap(const_cast<uint8_t*>(mapped_data), mapped_size);
+#endif
+		mapped_data = nullptr;
+		mapped_size = 0;
+	}
+
+	bool isOpen() const {
+		return mapped_data != nullptr;
+	}
+
+	const uint8_t* data() const {
+		return mapped_data;
+	}
+
+	size_t size() const {
+		return mapped_size;
+	}
+
+	// Returns a view of [offset, offset + length), throwing if the range lies outside the file
+	ByteSpan span(uint64_t offset, uint64_t length) const {
+		if (offset > mapped_size || length > mapped_size - offset) {
+			throw std::out_of_range("Mapped range out of bounds at offset: " + std::to_string(offset));
+		}
+		return ByteSpan(mapped_data + offset, static_cast<size_t>(length));
+	}
+
+	// Asks the OS to read [offset, offset + length) ahead, for ranges about to be scanned in full
+	void willNeed(uint64_t offset, uint64_t length) const {
+		if (mapped_data == nullptr || offset >= mapped_size) {
+			return;
+		}
+		length = std::min<uint64_t>(length, mapped_size - offset);
+
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(mapped_data + offset);
+		range.NumberOfBytes = static_cast<SIZE_T>(length);
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+		uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+		uint64_t aligned_offset = offset - offset % page_size;
+		madvise(const_cast<uint8_t*>(mapped_data + aligned_offset), static_cast<size_t>(length + offset - aligned_offset), MADV_WILLNEED);
+#endif
+	}
+
+private:
+	const uint8_t* mapped_data;
+	size_t mapped_size;
+};
+
+#endif // !MAPPED_FILE_H
@@ -0,0 +1,143 @@
+#ifndef PACK_FILE_H
+#define PACK_FILE_H
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+#include "MappedFile.h"
+
+// Reader for "PF" packfiles, the container of models, maps, materials and audio banks.
+//
+// A packfile is a 12-byte header followed by tagged chunks, each a 16-byte header and its
+// payload. The chunk table holds views into the caller's buffer, nothing is copied, so the
+// buffer must outlive the PackFile. Only the chunk headers are read, once, the first time the
+// table is asked for; payloads are left for the caller to decode as they are inspected, so a
+// 50 MB map costs one hop per chunk.
+class PackFile {
+public:
+	static constexpr size_t FILE_HEADER_SIZE = 12;
+	static constexpr size_t CHUNK_HEADER_SIZE = 16;
+
+	struct Header {
+		uint16_t flags;
+		uint16_t header_size;
+		char type[4]; // e.g. MODL, mapc, AMAT
+	};
+
+	struct Chunk {
+		char type[4];
+		uint64_t offset;            // of the chunk header within the file
+		uint16_t version;
+		uint16_t header_size;
+		uint32_t descriptor_offset; // of the chunk's pointer table, from the payload start
+		ByteSpan data;              // payload, after the chunk header
+
+		std::string typeName() const {
+			return std::string(type, 4);
+		}
+	};
+
+	static bool isPackFile(const uint8_t* data, size_t size) {
+		return size >= FILE_HEADER_SIZE && data[0] == 'P' && data[1] == 'F';
+	}
+
+	explicit PackFile(ByteSpan data) : data(data), chunks_parsed(false) {
+		if (!isPackFile(data.data, data.size)) {
+			throw std::runtime_error("Not a PF packfile");
+		}
+
+		header.flags = loadField<uint16_t>(2);
+		header.header_size = loadField<uint16_t>(6);
+		std::memcpy(header.type, data.data + 8, 4);
+		if (header.header_size < FILE_HEADER_SIZE || header.header_size > data.size) {
+			throw std::runtime_error("Invalid packfile header size: " + std::to_string(header.header_size));
+		}
+	}
+
+	const Header& getHeader() const {
+		return header;
+	}
+
+	std::string typeName() const {
+		return std::string(header.type, 4);
+	}
+
+	const std::vector<Chunk>& getChunks() {
+		parseChunks();
+		return chunks;
+	}
+
+	// First chunk of the given four-character type, or null
+	const Chunk* findChunk(const char* type) {
+		for (const Chunk& chunk : getChunks()) {
+			if (std::memcmp(chunk.type, type, 4) == 0) {
+				return &chunk;
+			}
+		}
+		return nullptr;
+	}
+
+	// Why the chunk table stops short of the end of the file; empty when it does not
+	const std::string& getError() {
+		parseChunks();
+		return error;
+	}
+
+private:
+	ByteSpan data;
+	Header header;
+	std::vector<Chunk> chunks;
+	std::string error;
+	bool chunks_parsed;
+
+	template <typename T>
+	T loadField(uint64_t offset) const {
+		T value;
+		std::memcpy(&value, data.data + offset, sizeof(T));
+		return value;
+	}
+
+	// Chunks chain by their size field, which counts the bytes after it. A damaged chain keeps
+	// the chunks read so far and records where it broke.
+	void parseChunks() {
+		if (chunks_parsed) {
+			return;
+		}
+		chunks_parsed = true;
+
+		uint64_t offset = header.header_size;
+		while (offset < data.size) {
+			if (data.size - offset < CHUNK_HEADER_SIZE) {
+				error = "Truncated chunk header at offset " + std::to_string(offset);
+				return;
+			}
+
+			Chunk chunk;
+			std::memcpy(chunk.type, data.data + offset, 4);
+			uint64_t chunk_end = offset + 8 + loadField<uint32_t>(offset + 4);
+			chunk.offset = offset;
+			chunk.version = loadField<uint16_t>(offset + 8);
+			chunk.header_size = loadField<uint16_t>(offset + 10);
+			chunk.descriptor_offset = loadField<uint32_t>(offset + 12);
+
+			if (chunk_end > data.size) {
+				error = "Chunk " + chunk.typeName() + " at offset " + std::to_string(offset) + " runs past the end of the file";
+				return;
+			}
+			if (chunk.header_size < CHUNK_HEADER_SIZE || offset + chunk.header_size > chunk_end) {
+				error = "Invalid header size in chunk " + chunk.typeName() + " at offset " + std::to_string(offset);
+				return;
+			}
+
+			chunk.data = data.subspan(static_cast<size_t>(offset + chunk.header_size),
+				static_cast<size_t>(chunk_end - offset - chunk.header_size));
+			chunks.push_back(chunk);
+			offset = chunk_end;
+		}
+	}
+};
+
+#endif // !PACK_FILE_H
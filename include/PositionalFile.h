@@ -0,0 +1,166 @@
+#ifndef POSITIONAL_FILE_H
+#define POSITIONAL_FILE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Read-only file handle with positional reads: pread on POSIX, overlapped ReadFile on Windows.
+// There is no shared file position, so any number of threads can read through one handle at
+// the same time.
+class PositionalFile {
+public:
+	PositionalFile() : file_size(0) {}
+
+	~PositionalFile() {
+		close();
+	}
+
+	PositionalFile(const PositionalFile&) = delete;
+	PositionalFile& operator=(const PositionalFile&) = delete;
+
+	bool open(const std::string& file_path) {
+		close();
+
+#ifdef _WIN32
+		// Overlapped so reads on the one handle are not serialized by the I/O manager
+		handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(handle, &size)) {
+			close();
+			return false;
+		}
+		file_size = static_cast<uint64_t>(size.QuadPart);
+#else
+		fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat file_stat;
+		if (fstat(fd, &file_stat) != 0) {
+			close();
+			return false;
+		}
+		file_size = static_cast<uint64_t>(file_stat.st_size);
+#endif
+		return true;
+	}
+
+	void close() {
+#ifdef _WIN32
+		if (handle != INVALID_HANDLE_VALUE) {
+			CloseHandle(handle);
+			handle = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+#endif
+		file_size = 0;
+	}
+
+	bool isOpen() const {
+#ifdef _WIN32
+		return handle != INVALID_HANDLE_VALUE;
+#else
+		return fd >= 0;
+#endif
+	}
+
+	uint64_t size() const {
+		return file_size;
+	}
+
+#ifndef _WIN32
+	// For APIs that take the descriptor directly, such as io_uring
+	int getDescriptor() const {
+		return fd;
+	}
+#endif
+
+	// Reads exactly length bytes at offset; false on an I/O error or when the range passes the
+	// end of the file
+	bool read(uint64_t offset, void* buffer, size_t length) const {
+		if (offset > file_size || length > file_size - offset) {
+			return false;
+		}
+
+		uint8_t* out = static_cast<uint8_t*>(buffer);
+		while (length != 0) {
+#ifdef _WIN32
+			DWORD request = static_cast<DWORD>(std::min(length, static_cast<size_t>(MAX_REQUEST)));
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+			if (overlapped.hEvent == nullptr) {
+				return false;
+			}
+
+			DWORD transferred = 0;
+			BOOL done = ReadFile(handle, out, request, nullptr, &overlapped);
+			if (!done && GetLastError() == ERROR_IO_PENDING) {
+				done = GetOverlappedResult(handle, &overlapped, &transferred, TRUE);
+			}
+			else if (done) {
+				done = GetOverlappedResult(handle, &overlapped, &transferred, FALSE);
+			}
+			CloseHandle(overlapped.hEvent);
+			if (!done || transferred == 0) {
+				return false;
+			}
+			size_t count = transferred;
+#else
+			ssize_t result = pread(fd, out, std::min(length, static_cast<size_t>(MAX_REQUEST)), static_cast<off_t>(offset));
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+			if (result <= 0) {
+				return false;
+			}
+			size_t count = static_cast<size_t>(result);
+#endif
+			out += count;
+			offset += count;
+			length -= count;
+		}
+		return true;
+	}
+
+private:
+	// Largest single request; both APIs take 32-bit lengths somewhere
+	static constexpr size_t MAX_REQUEST = 1u << 30;
+
+#ifdef _WIN32
+	HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+	int fd = -1;
+#endif
+	uint64_t file_size;
+};
+
+#endif // !POSITIONAL_FILE_H
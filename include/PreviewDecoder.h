@@ -0,0 +1,133 @@
+#ifndef PREVIEW_DECODER_H
+#define PREVIEW_DECODER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <stdexcept>
+
+// Decoded preview pixels, always 8-bit RGBA
+struct PreviewSurface {
+	int width = 0;
+	int height = 0;
+	std::vector<uint8_t> pixels;
+	std::string format; // what the decoder recognised, e.g. "PNG"
+	std::string error;  // set when the entry could not be decoded
+
+	bool valid() const {
+		return error.empty() && width > 0 && height > 0;
+	}
+};
+
+// Decodes preview images on a worker thread, once per selected entry.
+//
+// Only the newest submission matters: submitting while a decode is queued replaces it, and a
+// decode that finishes after a newer submission is dropped. The UI thread polls once per frame
+// and gets each finished surface exactly once, which is when it should upload the texture.
+class PreviewDecoder {
+public:
+	typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+	typedef std::function<PreviewSurface(const std::vector<uint8_t>&)> DecodeFunction;
+
+	explicit PreviewDecoder(DecodeFunction decode) : decode(std::move(decode)), submitted_generation(0),
+		has_pending(false), has_finished(false), stopping(false) {
+		worker = std::thread([this] { workerLoop(); });
+	}
+
+	~PreviewDecoder() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		condition.notify_all();
+		worker.join();
+	}
+
+	PreviewDecoder(const PreviewDecoder&) = delete;
+	PreviewDecoder& operator=(const PreviewDecoder&) = delete;
+
+	void submit(uint32_t mft_index, const Data& data) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending.mft_index = mft_index;
+			pending.data = data;
+			pending.generation = ++submitted_generation;
+			has_pending = true;
+			has_finished = false;
+		}
+		condition.notify_one();
+	}
+
+	// Hands over the surface of the latest submission once it is decoded
+	bool poll(uint32_t& mft_index, std::shared_ptr<const PreviewSurface>& surface) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!has_finished) {
+			return false;
+		}
+		mft_index = finished_index;
+		surface = std::move(finished_surface);
+		has_finished = false;
+		return true;
+	}
+
+private:
+	struct Job {
+		uint32_t mft_index = 0;
+		Data data;
+		uint64_t generation = 0;
+	};
+
+	DecodeFunction decode;
+	std::thread worker;
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	Job pending;
+	uint64_t submitted_generation;
+	bool has_pending;
+	uint32_t finished_index = 0;
+	std::shared_ptr<const PreviewSurface> finished_surface;
+	bool has_finished;
+	bool stopping;
+
+	void workerLoop() {
+		while (true) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this] { return stopping || has_pending; });
+				if (stopping) {
+					return;
+				}
+				job = std::move(pending);
+				pending = Job();
+				has_pending = false;
+			}
+
+			std::shared_ptr<PreviewSurface> surface;
+			try {
+				if (!job.data) {
+					throw std::invalid_argument("No entry data to preview");
+				}
+				surface = std::make_shared<PreviewSurface>(decode(*job.data));
+			}
+			catch (const std::exception& e) {
+				surface = std::make_shared<PreviewSurface>();
+				surface->error = e.what();
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (job.generation == submitted_generation) {
+				finished_index = job.mft_index;
+				finished_surface = surface;
+				has_finished = true;
+			}
+		}
+	}
+};
+
+#endif // !PREVIEW_DECODER_H
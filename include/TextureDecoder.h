@@ -0,0 +1,666 @@
+#ifndef TEXTURE_DECODER_H
+#define TEXTURE_DECODER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include "DatDecompress.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <tmmintrin.h>
+#define TEXTURE_DECODER_X86 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define TEXTURE_DECODER_X86 1
+#endif
+
+// Decoder for the archive's ATEX family of textures (ATEX, ATTX, ATEC, ATEP, ATEU, ATET).
+//
+// A texture file is a 12 byte header (magic, FourCC format, u16 width, u16 height) followed
+// by the top mip level in ANet's packed form, which inflateBlocks() turns back into BCn
+// blocks. DXT1/3/5 and 3DC payloads are decoded from their BC1/BC2/BC3/BC5 blocks to tightly
+// packed RGBA8 rows. Block palettes are built per block; with SSSE3 the 16 pixels of a block
+// are then expanded with byte shuffles, otherwise with scalar lookups.
+//
+// Packed layout, read with DatBitReader (MSB-first from little-endian words, no CRC words):
+//   32 bits  packed size
+//   32 bits  section flags
+//   sections, each a series of runs over the blocks it has not filled yet: a Huffman coded
+//   block count (fixed tree, 1 to 18) and a bit saying whether the run is filled
+//     0x1  transparent blocks: colour endpoints 0xFFFE / 0xFFFF, every index 3
+//     0x2  constant alpha, 4 bits, for explicit (BC2) alpha; filled runs carry one more bit,
+//          clear for alpha 0
+//     0x4  constant alpha, 8 bits, for interpolated (BC3) alpha; same runs
+//     0x8  plain colour, 24 bits, turned into two RGB565 endpoints and one index
+//   from the next word boundary, the blocks no section filled, stored as raw words: first
+//   component (alpha, or 3DC red) 8 bytes per block, then the first colour word of every
+//   block, then the second one
+// This follows the community description of the format (gw2DatTools).
+class TextureDecoder {
+public:
+	enum class BlockFormat {
+		BC1, // DXT1: RGB565 endpoints, 1-bit alpha
+		BC2, // DXT2/3: explicit 4-bit alpha + BC1 colour
+		BC3, // DXT4/5: interpolated alpha + BC1 colour
+		BC5  // 3DC: two interpolated channels (normal map X/Y), Z reconstructed
+	};
+
+	struct Header {
+		char magic[4];
+		char format[4];
+		uint16_t width;
+		uint16_t height;
+		BlockFormat block_format;
+	};
+
+	static constexpr size_t HEADER_SIZE = 12;
+
+	static bool isTexture(const uint8_t* data, size_t size) {
+		static const char* magics[] = { "ATEX", "ATTX", "ATEC", "ATEP", "ATEU", "ATET" };
+		if (size < HEADER_SIZE) {
+			return false;
+		}
+		for (const char* magic : magics) {
+			if (std::memcmp(data, magic, 4) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static Header readHeader(const uint8_t* data, size_t size) {
+		if (!isTexture(data, size)) {
+			throw std::runtime_error("Not an ATEX texture");
+		}
+
+		Header header;
+		std::memcpy(header.magic, data, 4);
+		std::memcpy(header.format, data + 4, 4);
+		std::memcpy(&header.width, data + 8, sizeof(header.width));
+		std::memcpy(&header.height, data + 10, sizeof(header.height));
+		if (!blockFormatOf(header.format, header.block_format)) {
+			throw std::runtime_error("Unsupported texture format: " + std::string(header.format, 4));
+		}
+		if (header.width == 0 || header.height == 0) {
+			throw std::runtime_error("Texture has no pixels");
+		}
+		return header;
+	}
+
+	static size_t blockSize(BlockFormat format) {
+		return format == BlockFormat::BC1 ? 8 : 16;
+	}
+
+	// Bytes of block data for the top mip level
+	static size_t surfaceSize(BlockFormat format, uint32_t width, uint32_t height) {
+		return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize(format);
+	}
+
+	// Decodes the top mip level of an ATEX-family file into width * height RGBA8 pixels
+	static std::vector<uint8_t> decode(const uint8_t* data, size_t size, Header& header) {
+		header = readHeader(data, size);
+		std::vector<uint8_t> blocks = inflateBlocks(header.block_format, header.width, header.height,
+			data + HEADER_SIZE, size - HEADER_SIZE);
+
+		std::vector<uint8_t> rgba(static_cast<size_t>(header.width) * header.height * 4);
+		decodeBlocks(header.block_format, blocks.data(), header.width, header.height, rgba.data());
+		return rgba;
+	}
+
+	// Unpacks ANet's packed texture data into surfaceSize() bytes of BCn blocks. Blocks the
+	// data stops short of stay zero.
+	static std::vector<uint8_t> inflateBlocks(BlockFormat format, uint32_t width, uint32_t height, const uint8_t* packed,
+		size_t packed_size) {
+		const size_t block_size = blockSize(format);
+		const size_t block_count = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+		// BC1 has only colour, its alpha is deduced from the endpoints; the other formats keep
+		// a first component (alpha, or red for 3DC) in front of the colour
+		const bool two_components = format != BlockFormat::BC1;
+		const size_t color_offset = two_components ? 8 : 0;
+
+		std::vector<uint8_t> blocks(block_count * block_size);
+		std::vector<bool> alpha_done(block_count, false);
+		std::vector<bool> color_done(block_count, false);
+
+		DatBitReader reader(packed, packed_size, false);
+		reader.read(32); // packed size
+		uint32_t flags = reader.read(32);
+		const DatHuffmanTable& counts = runCountTable();
+
+		if (flags & PACKED_TRANSPARENT) {
+			decodeRuns(reader, counts, color_done, readRunBit, [&](size_t block, uint32_t) {
+				storeWord(blocks.data() + block * block_size + color_offset, 0xFFFFFFFFFFFFFFFEull);
+				alpha_done[block] = true;
+			});
+		}
+
+		if (flags & PACKED_ALPHA_4BITS) {
+			uint64_t alpha = reader.read(4) * 0x1111111111111111ull;
+			decodeRuns(reader, counts, alpha_done, readAlphaRun, [&](size_t block, uint32_t run) {
+				storeWord(blocks.data() + block * block_size, run == ALPHA_RUN_CONSTANT ? alpha : 0);
+			});
+		}
+
+		if (flags & PACKED_ALPHA_8BITS) {
+			uint64_t alpha = reader.read(8) * 0x101ull;
+			decodeRuns(reader, counts, alpha_done, readAlphaRun, [&](size_t block, uint32_t run) {
+				storeWord(blocks.data() + block * block_size, run == ALPHA_RUN_CONSTANT ? alpha : 0);
+			});
+		}
+
+		if (flags & PACKED_PLAIN_COLOR) {
+			uint32_t red = reader.read(8);
+			uint32_t green = reader.read(8);
+			uint32_t blue = reader.read(8);
+			uint64_t color_block = plainColorBlock(red, green, blue, format == BlockFormat::BC1);
+			decodeRuns(reader, counts, color_done, readRunBit, [&](size_t block, uint32_t) {
+				storeWord(blocks.data() + block * block_size + color_offset, color_block);
+			});
+		}
+
+		// The raw words start at the first word no section read a bit of
+		DatBitReader::Position position = reader.getPosition();
+		size_t word = static_cast<size_t>(position.word_position) - position.bit_count / 32;
+		const size_t word_count = packed_size / 4;
+
+		if (two_components) {
+			for (size_t block = 0; block < block_count && word < word_count; ++block) {
+				if (!alpha_done[block]) {
+					std::memcpy(&blocks[block * block_size], packed + word * 4, std::min<size_t>(8, (word_count - word) * 4));
+					word += 2;
+				}
+			}
+		}
+		for (size_t half = 0; half < 2; ++half) {
+			for (size_t block = 0; block < block_count && word < word_count; ++block) {
+				if (!color_done[block]) {
+					std::memcpy(&blocks[block * block_size + color_offset + half * 4], packed + word * 4, 4);
+					++word;
+				}
+			}
+		}
+		return blocks;
+	}
+
+	// Decodes a whole BCn surface; rgba receives width * height * 4 bytes
+	static void decodeBlocks(BlockFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba,
+		bool allow_simd = true) {
+		const size_t block_size = blockSize(format);
+		const uint32_t block_columns = (width + 3) / 4;
+		const uint32_t block_rows = (height + 3) / 4;
+		const size_t stride = static_cast<size_t>(width) * 4;
+#if defined(TEXTURE_DECODER_X86)
+		const bool use_simd = allow_simd && hasSimdSupport();
+#else
+		(void)allow_simd;
+#endif
+
+		uint32_t block_pixels[16];
+		for (uint32_t block_y = 0; block_y < block_rows; ++block_y) {
+			for (uint32_t block_x = 0; block_x < block_columns; ++block_x) {
+				const uint8_t* block = blocks + (static_cast<size_t>(block_y) * block_columns + block_x) * block_size;
+				uint8_t* destination = rgba + static_cast<size_t>(block_y) * 4 * stride + static_cast<size_t>(block_x) * 16;
+				bool full_block = block_x * 4 + 4 <= width && block_y * 4 + 4 <= height;
+
+				// Interior blocks are written in place, edge blocks go through a scratch block
+				uint8_t* output = full_block ? destination : reinterpret_cast<uint8_t*>(block_pixels);
+				size_t output_stride = full_block ? stride : 16;
+#if defined(TEXTURE_DECODER_X86)
+				if (use_simd) {
+					decodeBlockSimd(format, block, output, output_stride);
+				}
+				else
+#endif
+				{
+					decodeBlockScalar(format, block, output, output_stride);
+				}
+
+				if (!full_block) {
+					uint32_t columns = std::min<uint32_t>(4, width - block_x * 4);
+					uint32_t rows = std::min<uint32_t>(4, height - block_y * 4);
+					for (uint32_t row = 0; row < rows; ++row) {
+						std::memcpy(destination + row * stride, block_pixels + row * 4, columns * 4);
+					}
+				}
+			}
+		}
+	}
+
+	static bool hasSimdSupport() {
+#if defined(TEXTURE_DECODER_X86)
+		static const bool supported = detectSsse3();
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+private:
+	static constexpr uint32_t PACKED_TRANSPARENT = 0x1;
+	static constexpr uint32_t PACKED_ALPHA_4BITS = 0x2;
+	static constexpr uint32_t PACKED_ALPHA_8BITS = 0x4;
+	static constexpr uint32_t PACKED_PLAIN_COLOR = 0x8;
+	static constexpr uint32_t ALPHA_RUN_ZERO = 1;
+	static constexpr uint32_t ALPHA_RUN_CONSTANT = 2;
+
+	// Run lengths: 1 has a 1-bit code, 18 a 2-bit one and 2 to 17 six bits each
+	static const DatHuffmanTable& runCountTable() {
+		struct Table {
+			DatHuffmanTable table;
+
+			Table() {
+				uint8_t code_lengths[19] = {};
+				code_lengths[1] = 1;
+				code_lengths[18] = 2;
+				std::fill(code_lengths + 2, code_lengths + 18, static_cast<uint8_t>(6));
+				table.build(code_lengths, 19, false);
+			}
+		};
+		static const Table instance;
+		return instance.table;
+	}
+
+	static void storeWord(uint8_t* destination, uint64_t value) {
+		std::memcpy(destination, &value, sizeof(value));
+	}
+
+	// 0 for a run left alone, otherwise the value passed on to the section
+	static uint32_t readRunBit(DatBitReader& reader) {
+		return reader.read(1);
+	}
+
+	static uint32_t readAlphaRun(DatBitReader& reader) {
+		if (reader.read(1) == 0) {
+			return 0;
+		}
+		return reader.read(1) ? ALPHA_RUN_CONSTANT : ALPHA_RUN_ZERO;
+	}
+
+	// Applies a section to the runs of blocks not yet done, marking the filled ones done
+	template <typename ReadRun, typename Apply>
+	static void decodeRuns(DatBitReader& reader, const DatHuffmanTable& counts, std::vector<bool>& done, ReadRun read_run,
+		Apply apply) {
+		size_t block = 0;
+		while (block < done.size()) {
+			uint32_t count = counts.decode(reader);
+			uint32_t run = read_run(reader);
+			while (count > 0) {
+				if (block >= done.size()) {
+					throw std::runtime_error("Packed texture run goes past the last block");
+				}
+				if (!done[block]) {
+					if (run != 0) {
+						apply(block, run);
+						done[block] = true;
+					}
+					--count;
+				}
+				++block;
+			}
+			while (block < done.size() && done[block]) {
+				++block;
+			}
+		}
+	}
+
+	// One RGB565 channel of a plain colour: the endpoint values to use and how far (0 to 12)
+	// the colour lies from the first one
+	static void quantizeChannel(uint32_t value, uint32_t bits, uint32_t& first, uint32_t& second, uint32_t& weight,
+		bool& split) {
+		uint32_t base;
+		uint32_t expanded;
+		uint32_t twin_mask;
+		if (bits == 5) {
+			base = (value - (value >> 5)) >> 3;
+			expanded = (base << 3) + (base >> 2);
+			twin_mask = 0x11;
+		}
+		else {
+			base = (value - (value >> 6)) >> 2;
+			expanded = (base << 2) + (base >> 4);
+			twin_mask = 0x1111;
+		}
+		uint32_t error = 12 * (value - expanded) / (8 - ((base & twin_mask) == twin_mask ? 1 : 0));
+
+		first = error < 6 ? base : base + 1;
+		second = (error < 2 || (error >= 6 && error < 10)) ? base : base + 1;
+		split = first != second;
+		weight = first == base ? error : 12 - error;
+	}
+
+	// The 8 colour bytes of a block showing one 24-bit colour
+	static uint64_t plainColorBlock(uint32_t red, uint32_t green, uint32_t blue, bool deduced_alpha) {
+		uint32_t red_1, red_2, green_1, green_2, blue_1, blue_2;
+		uint32_t weights[3];
+		bool splits[3];
+		quantizeChannel(red, 5, red_1, red_2, weights[0], splits[0]);
+		quantizeChannel(green, 6, green_1, green_2, weights[1], splits[1]);
+		quantizeChannel(blue, 5, blue_1, blue_2, weights[2], splits[2]);
+
+		uint32_t color_1 = (red_1 << 11) | (green_1 << 5) | blue_1;
+		uint32_t color_2 = (red_2 << 11) | (green_2 << 5) | blue_2;
+
+		uint32_t weight = 0;
+		uint32_t split_count = 0;
+		for (int channel = 0; channel < 3; ++channel) {
+			if (splits[channel]) {
+				weight += weights[channel];
+				++split_count;
+			}
+		}
+		if (split_count > 0) {
+			weight = (weight + split_count / 2) / split_count;
+		}
+
+		// BC1 keeps the midpoint, which its three-colour mode has as well
+		bool keep_midpoint = deduced_alpha && (weight == 5 || weight == 6 || split_count != 0);
+		if (split_count > 0 && !keep_midpoint) {
+			if (color_2 == 0xFFFF) {
+				weight = 12;
+				--color_1;
+			}
+			else {
+				weight = 0;
+				++color_2;
+			}
+		}
+
+		if (color_2 >= color_1) {
+			std::swap(color_1, color_2);
+			weight = 12 - weight;
+		}
+
+		uint64_t index;
+		if (keep_midpoint) {
+			index = 2;
+		}
+		else if (weight < 2) {
+			index = 0;
+		}
+		else if (weight < 6) {
+			index = 2;
+		}
+		else if (weight < 10) {
+			index = 3;
+		}
+		else {
+			index = 1;
+		}
+		return color_1 | (static_cast<uint64_t>(color_2) << 16) | (index * 0x55555555ull << 32);
+	}
+
+	static bool blockFormatOf(const char* fourcc, BlockFormat& format) {
+		std::string code(fourcc, 4);
+		if (code == "DXT1") {
+			format = BlockFormat::BC1;
+		}
+		else if (code == "DXT2" || code == "DXT3") {
+			format = BlockFormat::BC2;
+		}
+		else if (code == "DXT4" || code == "DXT5" || code == "DXTA" || code == "DXTL" || code == "DXTN") {
+			format = BlockFormat::BC3;
+		}
+		else if (code == "3DCX" || code == "ATI2") {
+			format = BlockFormat::BC5;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+	static uint32_t packRgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	// Four RGBA colours of a colour block; allow_three_color enables BC1's transparent fourth entry
+	static void colorPalette(const uint8_t* block, bool allow_three_color, uint32_t palette[4]) {
+		uint16_t color_0;
+		uint16_t color_1;
+		std::memcpy(&color_0, block, 2);
+		std::memcpy(&color_1, block + 2, 2);
+
+		uint32_t r[4], g[4], b[4];
+		r[0] = ((color_0 >> 11) & 0x1F) * 255 / 31;
+		g[0] = ((color_0 >> 5) & 0x3F) * 255 / 63;
+		b[0] = (color_0 & 0x1F) * 255 / 31;
+		r[1] = ((color_1 >> 11) & 0x1F) * 255 / 31;
+		g[1] = ((color_1 >> 5) & 0x3F) * 255 / 63;
+		b[1] = (color_1 & 0x1F) * 255 / 31;
+
+		palette[0] = packRgba(r[0], g[0], b[0], 255);
+		palette[1] = packRgba(r[1], g[1], b[1], 255);
+		if (color_0 > color_1 || !allow_three_color) {
+			palette[2] = packRgba((2 * r[0] + r[1]) / 3, (2 * g[0] + g[1]) / 3, (2 * b[0] + b[1]) / 3, 255);
+			palette[3] = packRgba((r[0] + 2 * r[1]) / 3, (g[0] + 2 * g[1]) / 3, (b[0] + 2 * b[1]) / 3, 255);
+		}
+		else {
+			palette[2] = packRgba((r[0] + r[1]) / 2, (g[0] + g[1]) / 2, (b[0] + b[1]) / 2, 255);
+			palette[3] = 0;
+		}
+	}
+
+	// Eight values of a BC3 alpha / BC4 channel block
+	static void channelPalette(const uint8_t* block, uint8_t palette[8]) {
+		uint32_t value_0 = block[0];
+		uint32_t value_1 = block[1];
+		palette[0] = static_cast<uint8_t>(value_0);
+		palette[1] = static_cast<uint8_t>(value_1);
+		if (value_0 > value_1) {
+			for (uint32_t i = 1; i < 7; ++i) {
+				palette[i + 1] = static_cast<uint8_t>(((7 - i) * value_0 + i * value_1) / 7);
+			}
+		}
+		else {
+			for (uint32_t i = 1; i < 5; ++i) {
+				palette[i + 1] = static_cast<uint8_t>(((5 - i) * value_0 + i * value_1) / 5);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	// 16 three-bit indices of a channel block, one per byte
+	static void channelIndices(const uint8_t* block, uint8_t indices[16]) {
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; ++i) {
+			bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+		}
+		for (int i = 0; i < 16; ++i) {
+			indices[i] = static_cast<uint8_t>((bits >> (3 * i)) & 0x7);
+		}
+	}
+
+	// Blue channel of a unit normal from its X/Y bytes
+	static const uint8_t* normalZTable() {
+		struct Table {
+			uint8_t values[256 * 256];
+
+			Table() {
+				for (int y = 0; y < 256; ++y) {
+					for (int x = 0; x < 256; ++x) {
+						float nx = x / 127.5f - 1.0f;
+						float ny = y / 127.5f - 1.0f;
+						float nz = std::sqrt(std::max(0.0f, 1.0f - nx * nx - ny * ny));
+						values[y * 256 + x] = static_cast<uint8_t>(nz * 127.5f + 127.5f);
+					}
+				}
+			}
+		};
+		static const Table table;
+		return table.values;
+	}
+
+	static void decodeBlockScalar(BlockFormat format, const uint8_t* block, uint8_t* output, size_t stride) {
+		uint32_t pixels[16];
+
+		if (format == BlockFormat::BC5) {
+			uint8_t red[8], green[8], red_indices[16], green_indices[16];
+			channelPalette(block, red);
+			channelPalette(block + 8, green);
+			channelIndices(block, red_indices);
+			channelIndices(block + 8, green_indices);
+			const uint8_t* z_table = normalZTable();
+			for (int i = 0; i < 16; ++i) {
+				uint8_t x = red[red_indices[i]];
+				uint8_t y = green[green_indices[i]];
+				pixels[i] = packRgba(x, y, z_table[y * 256 + x], 255);
+			}
+		}
+		else {
+			const uint8_t* color_block = format == BlockFormat::BC1 ? block : block + 8;
+			uint32_t palette[4];
+			colorPalette(color_block, format == BlockFormat::BC1, palette);
+			uint32_t color_indices;
+			std::memcpy(&color_indices, color_block + 4, 4);
+			for (int i = 0; i < 16; ++i) {
+				pixels[i] = palette[(color_indices >> (2 * i)) & 0x3];
+			}
+
+			if (format == BlockFormat::BC2) {
+				for (int i = 0; i < 16; ++i) {
+					uint32_t alpha = (block[i / 2] >> (4 * (i & 1))) & 0xF;
+					pixels[i] = (pixels[i] & 0x00FFFFFF) | ((alpha * 17) << 24);
+				}
+			}
+			else if (format == BlockFormat::BC3) {
+				uint8_t alpha[8], alpha_indices[16];
+				channelPalette(block, alpha);
+				channelIndices(block, alpha_indices);
+				for (int i = 0; i < 16; ++i) {
+					pixels[i] = (pixels[i] & 0x00FFFFFF) | (static_cast<uint32_t>(alpha[alpha_indices[i]]) << 24);
+				}
+			}
+		}
+
+		for (int row = 0; row < 4; ++row) {
+			std::memcpy(output + row * stride, pixels + row * 4, 16);
+		}
+	}
+
+#if defined(TEXTURE_DECODER_X86)
+	static bool detectSsse3() {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+#else
+		return __builtin_cpu_supports("ssse3");
+#endif
+	}
+
+	// Shuffle masks picking palette entry (index * 4 .. index * 4 + 3) for the 4 pixels of a row
+	struct RowMasks {
+		uint8_t masks[256][16];
+
+		RowMasks() {
+			for (int row_bits = 0; row_bits < 256; ++row_bits) {
+				for (int pixel = 0; pixel < 4; ++pixel) {
+					int index = (row_bits >> (2 * pixel)) & 0x3;
+					for (int byte = 0; byte < 4; ++byte) {
+						masks[row_bits][pixel * 4 + byte] = static_cast<uint8_t>(index * 4 + byte);
+					}
+				}
+			}
+		}
+	};
+
+	// 16 three-bit indices of a channel block, one per byte. Each 16-bit lane gathers the two
+	// bytes holding its index, then a multiply by 2^(8 - shift) lines the index up at bit 8.
+#if !defined(_MSC_VER)
+	__attribute__((target("ssse3")))
+#endif
+	static __m128i channelIndicesSimd(const uint8_t* block) {
+		const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+		const __m128i gather_low = _mm_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5);
+		const __m128i gather_high = _mm_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, -1, 7, -1);
+		const __m128i multipliers = _mm_setr_epi16(1 << 8, 1 << 5, 1 << 2, 1 << 7, 1 << 4, 1 << 1, 1 << 6, 1 << 3);
+		const __m128i index_mask = _mm_set1_epi16(0x7);
+
+		__m128i low = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, gather_low), multipliers), 8), index_mask);
+		__m128i high = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, gather_high), multipliers), 8), index_mask);
+		return _mm_packus_epi16(low, high);
+	}
+
+#if !defined(_MSC_VER)
+	__attribute__((target("ssse3")))
+#endif
+	static void decodeBlockSimd(BlockFormat format, const uint8_t* block, uint8_t* output, size_t stride) {
+		static const RowMasks row_masks;
+
+		if (format == BlockFormat::BC5) {
+			uint8_t red_palette[16] = {};
+			uint8_t green_palette[16] = {};
+			channelPalette(block, red_palette);
+			channelPalette(block + 8, green_palette);
+			uint8_t red[16], green[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(red),
+				_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(red_palette)), channelIndicesSimd(block)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(green),
+				_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(green_palette)), channelIndicesSimd(block + 8)));
+
+			// The normal Z lookup has no shuffle equivalent
+			const uint8_t* z_table = normalZTable();
+			for (int row = 0; row < 4; ++row) {
+				uint32_t pixels[4];
+				for (int column = 0; column < 4; ++column) {
+					int i = row * 4 + column;
+					pixels[column] = packRgba(red[i], green[i], z_table[green[i] * 256 + red[i]], 255);
+				}
+				std::memcpy(output + row * stride, pixels, 16);
+			}
+			return;
+		}
+
+		const uint8_t* color_block = format == BlockFormat::BC1 ? block : block + 8;
+		uint32_t palette_values[4];
+		colorPalette(color_block, format == BlockFormat::BC1, palette_values);
+		const __m128i palette = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette_values));
+
+		__m128i rows[4];
+		for (int row = 0; row < 4; ++row) {
+			const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_masks.masks[color_block[4 + row]]));
+			rows[row] = _mm_shuffle_epi8(palette, mask);
+		}
+
+		if (format != BlockFormat::BC1) {
+			// 16 alpha bytes in pixel order
+			__m128i alphas;
+			if (format == BlockFormat::BC2) {
+				__m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+				__m128i low = _mm_and_si128(packed, _mm_set1_epi8(0x0F));
+				__m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), _mm_set1_epi8(0x0F));
+				__m128i nibbles = _mm_unpacklo_epi8(low, high);
+				alphas = _mm_or_si128(nibbles, _mm_slli_epi16(nibbles, 4));
+			}
+			else {
+				uint8_t alpha_palette[16] = {};
+				channelPalette(block, alpha_palette);
+				alphas = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha_palette)), channelIndicesSimd(block));
+			}
+
+			const __m128i color_mask = _mm_set1_epi32(0x00FFFFFF);
+			for (int row = 0; row < 4; ++row) {
+				// Move alphas 4 * row .. 4 * row + 3 into the top byte of each pixel
+				const char base = static_cast<char>(row * 4);
+				const __m128i spread = _mm_setr_epi8(-1, -1, -1, base, -1, -1, -1, static_cast<char>(base + 1),
+					-1, -1, -1, static_cast<char>(base + 2), -1, -1, -1, static_cast<char>(base + 3));
+				rows[row] = _mm_or_si128(_mm_and_si128(rows[row], color_mask), _mm_shuffle_epi8(alphas, spread));
+			}
+		}
+
+		for (int row = 0; row < 4; ++row) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + row * stride), rows[row]);
+		}
+	}
+#endif
+};
+
+#endif // !TEXTURE_DECODER_H
@@ -0,0 +1,183 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+// Work-stealing thread pool.
+// Tasks submitted from outside the pool go to a shared injection queue and start in submission
+// order, so callers that submit in archive offset order get sequential reads. Tasks submitted
+// from a worker land on that worker's own deque. A worker pops its own newest task first, then
+// the oldest injected task, and when both are empty steals the oldest task from another worker.
+// A task that throws does not take the worker down: the first exception is kept and rethrown by
+// wait().
+class ThreadPool {
+public:
+	explicit ThreadPool(size_t thread_count = 0) : queued_tasks(0), unfinished_tasks(0), stopping(false) {
+		if (thread_count == 0) {
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		for (size_t i = 0; i < thread_count; ++i) {
+			queues.emplace_back(new WorkerQueue());
+		}
+		for (size_t i = 0; i < thread_count; ++i) {
+			workers.emplace_back([this, i] { workerLoop(i); });
+		}
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			stopping = true;
+		}
+		wake_condition.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t size() const {
+		return workers.size();
+	}
+
+	void submit(std::function<void()> task) {
+		const WorkerIdentity& identity = currentWorker();
+		WorkerQueue& queue = identity.pool == this ? *queues[identity.index] : injected;
+
+		unfinished_tasks++;
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			++queued_tasks;
+		}
+		wake_condition.notify_one();
+	}
+
+	// Blocks until every submitted task has finished, then rethrows the first exception a task
+	// threw since the last wait(); must not be called from a worker
+	void wait() {
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		idle_condition.wait(lock, [this] { return unfinished_tasks == 0; });
+		if (task_exception) {
+			std::exception_ptr exception = task_exception;
+			task_exception = nullptr;
+			std::rethrow_exception(exception);
+		}
+	}
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	struct WorkerIdentity {
+		const ThreadPool* pool;
+		size_t index;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	WorkerQueue injected; // submitted from outside the pool, popped oldest first
+	std::vector<std::thread> workers;
+	std::mutex wake_mutex;
+	std::condition_variable wake_condition;
+	std::condition_variable idle_condition;
+	size_t queued_tasks;
+	std::exception_ptr task_exception; // guarded by wake_mutex
+	std::atomic<size_t> unfinished_tasks;
+	bool stopping;
+
+	static WorkerIdentity& currentWorker() {
+		static thread_local WorkerIdentity identity = { nullptr, 0 };
+		return identity;
+	}
+
+	bool popTask(size_t index, std::function<void()>& task) {
+		// Own queue, newest first
+		{
+			WorkerQueue& own = *queues[index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+
+		// Oldest task submitted from outside
+		{
+			std::lock_guard<std::mutex> lock(injected.mutex);
+			if (!injected.tasks.empty()) {
+				task = std::move(injected.tasks.front());
+				injected.tasks.pop_front();
+				return true;
+			}
+		}
+
+		// Steal the oldest task from the other workers
+		for (size_t i = 1; i < queues.size(); ++i) {
+			WorkerQueue& victim = *queues[(index + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void workerLoop(size_t index) {
+		currentWorker() = { this, index };
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(wake_mutex);
+				wake_condition.wait(lock, [this] { return stopping || queued_tasks > 0; });
+				if (queued_tasks == 0) {
+					return;
+				}
+				--queued_tasks;
+			}
+
+			// A queued task is reserved for this worker, keep looking until it shows up
+			std::function<void()> task;
+			while (!popTask(index, task)) {
+				std::this_thread::yield();
+			}
+
+			try {
+				task();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(wake_mutex);
+				if (!task_exception) {
+					task_exception = std::current_exception();
+				}
+			}
+
+			if (--unfinished_tasks == 0) {
+				std::lock_guard<std::mutex> lock(wake_mutex);
+				idle_condition.notify_all();
+			}
+		}
+	}
+};
+
+#endif // !THREAD_POOL_H
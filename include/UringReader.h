@@ -0,0 +1,362 @@
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+// Pulled in from linux/fs.h; clashes with the buffer size constants of the stream classes
+#undef BLOCK_SIZE
+#undef BLOCK_SIZE_BITS
+#endif
+
+#include "PositionalFile.h"
+
+// Batched reads of many archive ranges through Linux io_uring, without liburing.
+//
+// The reader owns buffer_count buffers of buffer_size bytes, registered with the kernel once so
+// reads into them skip the per-call page pinning. A batch is a list of ranges read back to back
+// into one buffer; batches are submitted without blocking and their reads kept queue_depth deep,
+// so hundreds of small entry reads cost a handful of system calls instead of one each. Each
+// batch is handed back whole once all of its reads have landed. One thread drives the reader.
+//
+// The constructor throws where io_uring is unavailable (other platforms, old kernels, seccomp
+// sandboxes); callers then keep to plain positional reads.
+class UringReader {
+public:
+	struct Range {
+		uint64_t offset;
+		size_t length;
+	};
+
+	UringReader(const PositionalFile& file, size_t buffer_count, size_t buffer_size, unsigned queue_depth = 128) :
+		buffer_size(buffer_size), queue_depth(queue_depth), in_flight(0), batches(buffer_count) {
+#ifdef __linux__
+		if (!file.isOpen()) {
+			throw std::runtime_error("io_uring reader needs an open file");
+		}
+		fd = file.getDescriptor();
+		storage.reset(new uint8_t[buffer_count * buffer_size]);
+		setupRing();
+
+		std::vector<iovec> iovecs(buffer_count);
+		for (size_t i = 0; i < buffer_count; ++i) {
+			iovecs[i].iov_base = getBuffer(i);
+			iovecs[i].iov_len = buffer_size;
+		}
+		// Pinned memory counts against RLIMIT_MEMLOCK; without registration reads still work, unpinned
+		registered = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+			static_cast<unsigned>(iovecs.size())) == 0;
+
+		for (size_t i = 0; i < queue_depth; ++i) {
+			free_slots.push_back(static_cast<uint32_t>(i));
+		}
+		slots.resize(queue_depth);
+#else
+		(void)file;
+		throw std::runtime_error("io_uring is only available on Linux");
+#endif
+	}
+
+	~UringReader() {
+#ifdef __linux__
+		// The kernel may still write into the buffers, so every read has to land before they go
+		while (in_flight != 0) {
+			if (enter(0, 1) < 0 && errno != EINTR) {
+				break;
+			}
+			reapCompletions();
+		}
+		if (registered) {
+			syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+		}
+		if (sqes != MAP_FAILED) {
+			munmap(sqes, sqe_map_size);
+		}
+		if (cq_map != MAP_FAILED && cq_map != sq_map) {
+			munmap(cq_map, cq_map_size);
+		}
+		if (sq_map != MAP_FAILED) {
+			munmap(sq_map, sq_map_size);
+		}
+		if (ring_fd >= 0) {
+			close(ring_fd);
+		}
+#endif
+	}
+
+	UringReader(const UringReader&) = delete;
+	UringReader& operator=(const UringReader&) = delete;
+
+	size_t getBufferCount() const {
+		return batches.size();
+	}
+
+	size_t getBufferSize() const {
+		return buffer_size;
+	}
+
+	uint8_t* getBuffer(size_t buffer_index) {
+		return storage.get() + buffer_index * buffer_size;
+	}
+
+	// Whether the kernel accepted the buffers as fixed buffers
+	bool isRegistered() const {
+		return registered;
+	}
+
+	// Batches submitted and not yet returned by wait()
+	size_t pendingCount() const {
+		return pending_batches;
+	}
+
+	// Queues reads of ranges, back to back, into a buffer not currently in a batch; returns at once
+	void submit(size_t buffer_index, const Range* ranges, size_t count) {
+		Batch& batch = batches[buffer_index];
+		if (batch.busy) {
+			throw std::logic_error("io_uring buffer " + std::to_string(buffer_index) + " is still in use");
+		}
+
+		uint64_t total = 0;
+		for (size_t i = 0; i < count; ++i) {
+			total += ranges[i].length;
+		}
+		if (total > buffer_size) {
+			throw std::length_error("Batch of " + std::to_string(total) + " bytes does not fit a " +
+				std::to_string(buffer_size) + " byte buffer");
+		}
+
+		batch.busy = true;
+		batch.ok = true;
+		batch.remaining = 0;
+		uint8_t* destination = getBuffer(buffer_index);
+		for (size_t i = 0; i < count; ++i) {
+			uint64_t offset = ranges[i].offset;
+			size_t length = ranges[i].length;
+			while (length != 0) {
+				uint32_t piece = static_cast<uint32_t>(std::min(length, static_cast<size_t>(MAX_REQUEST)));
+				waiting.push_back({ static_cast<uint32_t>(buffer_index), piece, offset, destination });
+				++batch.remaining;
+				destination += piece;
+				offset += piece;
+				length -= piece;
+			}
+		}
+		++pending_batches;
+		if (batch.remaining == 0) {
+			finished.push_back(buffer_index);
+		}
+		fillQueue();
+		if (to_submit != 0) {
+			enter(0, 0);
+		}
+	}
+
+	// Blocks until a submitted batch has been read in full and returns its buffer index, which
+	// may then be submitted again. ok is false when any of its reads failed or came up short.
+	size_t wait(bool& ok) {
+		if (pending_batches == 0) {
+			throw std::logic_error("No io_uring batch pending");
+		}
+		while (finished.empty()) {
+			fillQueue();
+			if (enter(0, 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+				throw std::runtime_error("io_uring_enter failed: " + std::string(std::strerror(errno)));
+			}
+			reapCompletions();
+		}
+
+		size_t buffer_index = finished.front();
+		finished.pop_front();
+		Batch& batch = batches[buffer_index];
+		batch.busy = false;
+		ok = batch.ok;
+		--pending_batches;
+		return buffer_index;
+	}
+
+private:
+	// Largest single read, well inside the 32-bit length of a submission
+	static constexpr size_t MAX_REQUEST = 1u << 30;
+
+	struct Read {
+		uint32_t buffer_index;
+		uint32_t length;
+		uint64_t offset;
+		uint8_t* destination;
+	};
+
+	struct Batch {
+		bool busy = false;
+		bool ok = true;
+		size_t remaining = 0;
+	};
+
+	size_t buffer_size;
+	unsigned queue_depth;
+	size_t in_flight;
+	size_t pending_batches = 0;
+	std::unique_ptr<uint8_t[]> storage;
+	std::vector<Batch> batches;
+	std::deque<Read> waiting;     // reads not yet handed to the kernel
+	std::vector<Read> slots;      // reads in flight, by submission user_data
+	std::vector<uint32_t> free_slots;
+	std::deque<size_t> finished;  // batches read in full, in completion order
+	bool registered = false;
+	unsigned to_submit = 0;
+
+#ifdef __linux__
+	int fd = -1;
+	int ring_fd = -1;
+	void* sq_map = MAP_FAILED;
+	void* cq_map = MAP_FAILED;
+	io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	size_t sq_map_size = 0;
+	size_t cq_map_size = 0;
+	size_t sqe_map_size = 0;
+	unsigned* sq_tail = nullptr;
+	unsigned* sq_mask = nullptr;
+	unsigned* sq_array = nullptr;
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned* cq_mask = nullptr;
+	io_uring_cqe* cqes = nullptr;
+
+	void setupRing() {
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+		if (ring_fd < 0) {
+			throw std::runtime_error("io_uring_setup failed: " + std::string(std::strerror(errno)));
+		}
+		sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_map) {
+			sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+		}
+
+		sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+		if (sq_map == MAP_FAILED) {
+			close(ring_fd);
+			throw std::runtime_error("Failed to map the io_uring submission ring");
+		}
+		cq_map = single_map ? sq_map :
+			mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		sqe_map_size = params.sq_entries * sizeof(io_uring_sqe);
+		void* sqe_map = cq_map == MAP_FAILED ? MAP_FAILED :
+			mmap(nullptr, sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+		if (sqe_map == MAP_FAILED) {
+			if (cq_map != MAP_FAILED && cq_map != sq_map) {
+				munmap(cq_map, cq_map_size);
+			}
+			munmap(sq_map, sq_map_size);
+			close(ring_fd);
+			throw std::runtime_error("Failed to map the io_uring queues");
+		}
+		sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+		uint8_t* sq = static_cast<uint8_t*>(sq_map);
+		sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		uint8_t* cq = static_cast<uint8_t*>(cq_map);
+		cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	}
+
+	// Moves waiting reads into the submission ring while slots are free
+	void fillQueue() {
+		unsigned tail = *sq_tail;
+		while (!waiting.empty() && !free_slots.empty()) {
+			uint32_t slot = free_slots.back();
+			free_slots.pop_back();
+			slots[slot] = waiting.front();
+			waiting.pop_front();
+			const Read& read = slots[slot];
+
+			unsigned index = tail & *sq_mask;
+			io_uring_sqe& sqe = sqes[index];
+			std::memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+			sqe.fd = fd;
+			sqe.off = read.offset;
+			sqe.addr = reinterpret_cast<uint64_t>(read.destination);
+			sqe.len = read.length;
+			if (registered) {
+				sqe.buf_index = static_cast<uint16_t>(read.buffer_index);
+			}
+			sqe.user_data = slot;
+			sq_array[index] = index;
+			++tail;
+			++to_submit;
+			++in_flight;
+		}
+		__atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+	}
+
+	int enter(unsigned submit_count, unsigned min_complete) {
+		submit_count = std::max(submit_count, to_submit);
+		int result = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, submit_count, min_complete,
+			min_complete != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0));
+		if (result > 0) {
+			to_submit -= std::min(to_submit, static_cast<unsigned>(result));
+		}
+		return result;
+	}
+
+	void reapCompletions() {
+		unsigned head = *cq_head;
+		unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head) {
+			const io_uring_cqe& cqe = cqes[head & *cq_mask];
+			uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+			Read read = slots[slot];
+			free_slots.push_back(slot);
+			--in_flight;
+
+			if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+				waiting.push_front(read);
+				continue;
+			}
+			if (cqe.res > 0 && static_cast<uint32_t>(cqe.res) < read.length) {
+				// Short read, queue the rest
+				read.destination += cqe.res;
+				read.offset += static_cast<uint32_t>(cqe.res);
+				read.length -= static_cast<uint32_t>(cqe.res);
+				waiting.push_front(read);
+				continue;
+			}
+
+			Batch& batch = batches[read.buffer_index];
+			if (cqe.res <= 0) {
+				batch.ok = false;
+			}
+			if (--batch.remaining == 0) {
+				finished.push_back(read.buffer_index);
+			}
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+#else
+	void fillQueue() {}
+	int enter(unsigned, unsigned) { return -1; }
+	void reapCompletions() {}
+#endif
+};
+
+#endif // !URING_READER_H
@@ -0,0 +1,336 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "DatFile.h"
+#include "DatWriter.h"
+#include "TextureDecoder.h"
+#include "ThreadPool.h"
+
+// Regression benchmark of the DatFile hot paths on a deterministic synthetic archive.
+// The fixture is generated from a fixed seed, so runs on different commits time the same
+// bytes. Results go to stdout as JSON, a readable summary to stderr.
+// Usage: gw2viewer-bench [--entries N] [--iterations N] [--fixture path.dat] [--keep]
+
+static const uint32_t FIXTURE_SEED = 0x6A7B2C3D;
+
+struct Fixture {
+	std::string path;
+	uint32_t entries = 0;
+	uint64_t bytes = 0;
+	std::vector<uint32_t> file_ids;
+};
+
+struct Measurement {
+	std::string name;
+	double median_seconds = 0.0;
+	double min_seconds = 0.0;
+	uint64_t bytes = 0; // processed per iteration, 0 when throughput is not meaningful
+	uint64_t items = 0;
+};
+
+// Keeps the optimizer from discarding the work being timed
+static volatile uint64_t sink = 0;
+
+static std::vector<uint8_t> makeRecordData(size_t size, std::mt19937& rng) {
+	// Small structured records: repeating field layout with a few varying values
+	std::vector<uint8_t> data(size);
+	uint32_t field = rng();
+	for (size_t i = 0; i < size; ++i) {
+		if (i % 16 == 0) {
+			field += rng() % 4;
+		}
+		data[i] = i % 16 < 4 ? static_cast<uint8_t>(field >> (8 * (i % 4))) : static_cast<uint8_t>(i % 16);
+	}
+	return data;
+}
+
+static std::vector<uint8_t> makeTextData(size_t size, std::mt19937& rng) {
+	static const char* words[] = {
+		"guild", "wars", "tyria", "asura", "charr", "norn", "sylvari", "human", "dragon", "jade",
+		"sea", "lion's", "arch", "divinity's", "reach", "the", "of", "and", "a", "to",
+	};
+	std::vector<uint8_t> data;
+	data.reserve(size);
+	while (data.size() < size) {
+		const char* word = words[rng() % (sizeof(words) / sizeof(words[0]))];
+		data.insert(data.end(), word, word + std::strlen(word));
+		data.push_back(rng() % 8 == 0 ? '\n' : ' ');
+	}
+	data.resize(size);
+	return data;
+}
+
+// ATEX texture with random blocks, packed with no sections so every block is stored raw;
+// decode speed does not depend on the colours
+static std::vector<uint8_t> makeTexture(const char* format, uint16_t size, std::mt19937& rng) {
+	const size_t packed_header_size = 8;
+	size_t block_bytes = std::strcmp(format, "DXT1") == 0 ? 8 : 16;
+	std::vector<uint8_t> data(TextureDecoder::HEADER_SIZE + packed_header_size + block_bytes * (size / 4) * (size / 4));
+	std::memcpy(data.data(), "ATEX", 4);
+	std::memcpy(data.data() + 4, format, 4);
+	std::memcpy(data.data() + 8, &size, 2);
+	std::memcpy(data.data() + 10, &size, 2);
+	uint32_t packed_size = static_cast<uint32_t>(data.size() - TextureDecoder::HEADER_SIZE);
+	std::memcpy(data.data() + TextureDecoder::HEADER_SIZE, &packed_size, 4); // section flags stay 0
+	for (size_t i = TextureDecoder::HEADER_SIZE + packed_header_size; i < data.size(); ++i) {
+		data[i] = static_cast<uint8_t>(rng());
+	}
+	return data;
+}
+
+// Mostly small records, some larger text blobs and a texture every 200 entries; about
+// two thirds compressed
+static Fixture writeFixture(const std::string& path, uint32_t entry_count) {
+	std::mt19937 rng(FIXTURE_SEED);
+	DatWriter writer(path);
+	Fixture fixture;
+	fixture.path = path;
+
+	for (uint32_t i = 0; i < entry_count; ++i) {
+		uint32_t file_id = 10000 + i * 3 + rng() % 3;
+		std::vector<uint8_t> data;
+		if (i % 200 == 199) {
+			data = makeTexture(i % 400 == 399 ? "DXT5" : "DXT1", 256, rng);
+		}
+		else if (i % 4 == 3) {
+			data = makeTextData(4096 + rng() % (32 * 1024), rng);
+		}
+		else {
+			data = makeRecordData(64 + rng() % 4096, rng);
+		}
+		writer.addEntry(data.data(), data.size(), rng() % 3 != 0, file_id);
+		fixture.file_ids.push_back(file_id);
+	}
+
+	writer.finish();
+	fixture.entries = entry_count;
+	fixture.bytes = writer.getBytesWritten();
+	return fixture;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Function>
+static Measurement measure(const std::string& name, int iterations, uint64_t bytes, uint64_t items, Function function) {
+	std::vector<double> times;
+	for (int i = 0; i < iterations; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		function();
+		times.push_back(secondsSince(start));
+	}
+	std::sort(times.begin(), times.end());
+
+	Measurement measurement;
+	measurement.name = name;
+	measurement.median_seconds = times[times.size() / 2];
+	measurement.min_seconds = times.front();
+	measurement.bytes = bytes;
+	measurement.items = items;
+	return measurement;
+}
+
+static void printJson(const Fixture& fixture, int iterations, const std::vector<Measurement>& measurements) {
+	std::printf("{\n");
+	std::printf("  \"benchmark\": \"gw2viewer-bench\",\n");
+	std::printf("  \"fixture\": { \"seed\": %u, \"entries\": %u, \"bytes\": %llu },\n", FIXTURE_SEED, fixture.entries,
+		static_cast<unsigned long long>(fixture.bytes));
+	std::printf("  \"iterations\": %d,\n", iterations);
+	std::printf("  \"results\": [\n");
+	for (size_t i = 0; i < measurements.size(); ++i) {
+		const Measurement& m = measurements[i];
+		std::printf("    { \"name\": \"%s\", \"median_ms\": %.4f, \"min_ms\": %.4f, \"bytes\": %llu, \"items\": %llu, "
+			"\"mb_per_s\": %.2f, \"items_per_s\": %.1f }%s\n",
+			m.name.c_str(), m.median_seconds * 1000.0, m.min_seconds * 1000.0, static_cast<unsigned long long>(m.bytes),
+			static_cast<unsigned long long>(m.items), m.bytes / 1e6 / m.median_seconds, m.items / m.median_seconds,
+			i + 1 < measurements.size() ? "," : "");
+	}
+	std::printf("  ]\n");
+	std::printf("}\n");
+}
+
+// Archives stay open only inside, so the fixture can be deleted afterwards
+static std::vector<Measurement> runBenchmarks(const Fixture& fixture, int iterations) {
+	std::vector<Measurement> measurements;
+	const uint64_t table_bytes = static_cast<uint64_t>(fixture.entries + DatWriter::FIRST_ENTRY_INDEX + 1) * MFT_ENTRY_SIZE;
+
+	measurements.push_back(measure("load_mapped", iterations, table_bytes, fixture.entries, [&] {
+		DatFile dat_file(fixture.path, DatFile::ReadMode::Mapped, false);
+		sink += dat_file.getMftData().size();
+	}));
+	measurements.push_back(measure("load_stream", iterations, table_bytes, fixture.entries, [&] {
+		DatFile dat_file(fixture.path, DatFile::ReadMode::Stream, false);
+		sink += dat_file.getMftData().size();
+	}));
+	DatFile(fixture.path, DatFile::ReadMode::Mapped, true).writeCache();
+	measurements.push_back(measure("load_cached", iterations, table_bytes, fixture.entries, [&] {
+		DatFile dat_file(fixture.path, DatFile::ReadMode::Mapped, true);
+		sink += dat_file.getMftData().size();
+	}));
+
+	DatFile dat_file(fixture.path, DatFile::ReadMode::Mapped, false);
+	DatFile stream_file(fixture.path, DatFile::ReadMode::Stream, false);
+	const auto& mft_data = dat_file.getMftData();
+
+	// Added entries in archive order; the MFT and index table are not part of the workload
+	std::vector<uint32_t> entries;
+	uint64_t raw_bytes = 0;
+	for (uint32_t i = DatWriter::FIRST_ENTRY_INDEX; i < mft_data.size(); ++i) {
+		entries.push_back(i);
+		raw_bytes += mft_data[i].size;
+	}
+
+	measurements.push_back(measure("read_compressed_mapped", iterations, raw_bytes, entries.size(), [&] {
+		for (uint32_t index : entries) {
+			sink += dat_file.readCompressedData(mft_data[index]).size();
+		}
+	}));
+	measurements.push_back(measure("read_compressed_stream", iterations, raw_bytes, entries.size(), [&] {
+		for (uint32_t index : entries) {
+			sink += stream_file.readCompressedData(mft_data[index]).size();
+		}
+	}));
+	// Same reads split across a pool, all threads sharing the one stream handle
+	ThreadPool pool;
+	const size_t slice_size = (entries.size() + pool.size() - 1) / pool.size();
+	std::vector<uint64_t> slice_totals(pool.size());
+	measurements.push_back(measure("read_compressed_stream_parallel", iterations, raw_bytes, entries.size(), [&] {
+		for (size_t slice = 0; slice < pool.size(); ++slice) {
+			pool.submit([&, slice] {
+				size_t end = std::min(entries.size(), (slice + 1) * slice_size);
+				for (size_t i = slice * slice_size; i < end; ++i) {
+					slice_totals[slice] += stream_file.readCompressedData(mft_data[entries[i]]).size();
+				}
+			});
+		}
+		pool.wait();
+	}));
+	for (uint64_t total : slice_totals) {
+		sink += total;
+	}
+	measurements.push_back(measure("remove_crc32", iterations, raw_bytes, entries.size(), [&] {
+		for (uint32_t index : entries) {
+			sink += dat_file.removeCrc32Data(mft_data[index]).size();
+		}
+	}));
+	measurements.push_back(measure("remove_crc32_verify", iterations, raw_bytes, entries.size(), [&] {
+		for (uint32_t index : entries) {
+			sink += dat_file.removeCrc32Data(mft_data[index], true).size();
+		}
+	}));
+
+	// Substring queries over the file ids, the search index is built before timing
+	std::mt19937 rng(FIXTURE_SEED);
+	std::vector<uint32_t> queries;
+	for (int i = 0; i < 1000; ++i) {
+		uint32_t file_id = fixture.file_ids[rng() % fixture.file_ids.size()];
+		queries.push_back(i % 2 == 0 ? file_id : file_id % 1000);
+	}
+	sink += dat_file.findMftData(1, false).size();
+	measurements.push_back(measure("find_mft_data", iterations, 0, queries.size(), [&] {
+		for (uint32_t query : queries) {
+			sink += dat_file.findMftData(query, false).size();
+		}
+	}));
+
+	std::vector<uint32_t> compressed_entries;
+	uint64_t inflated_bytes = 0;
+	std::vector<std::vector<uint8_t>> textures;
+	uint64_t texture_pixels = 0;
+	for (uint32_t index : entries) {
+		std::vector<uint8_t> data = dat_file.readDecompressedData(mft_data[index]);
+		if (mft_data[index].compression_flag != 0) {
+			compressed_entries.push_back(index);
+			inflated_bytes += data.size();
+		}
+		if (TextureDecoder::isTexture(data.data(), data.size())) {
+			TextureDecoder::Header header = TextureDecoder::readHeader(data.data(), data.size());
+			texture_pixels += static_cast<uint64_t>(header.width) * header.height;
+			textures.push_back(std::move(data));
+		}
+	}
+	measurements.push_back(measure("decompress", iterations, inflated_bytes, compressed_entries.size(), [&] {
+		for (uint32_t index : compressed_entries) {
+			sink += DatFile::inflateEntryData(dat_file.getEntrySpan(mft_data[index])).size();
+		}
+	}));
+	measurements.push_back(measure("texture_decode", iterations, texture_pixels * 4, textures.size(), [&] {
+		for (const auto& texture : textures) {
+			TextureDecoder::Header header;
+			sink += TextureDecoder::decode(texture.data(), texture.size(), header).size();
+		}
+	}));
+	return measurements;
+}
+
+// The archive and the MFT cache its load_cached run wrote
+static void removeFixture(const std::string& path) {
+	// The cache is named after the archive's absolute path, which needs the archive to resolve
+	std::remove(DatCache::pathFor(path).c_str());
+	std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+	uint32_t entry_count = 20000;
+	int iterations = 5;
+	std::string fixture_path = "gw2viewer-bench-fixture.dat";
+	bool keep_fixture = false;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		if (argument == "--entries" && i + 1 < argc) {
+			entry_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--iterations" && i + 1 < argc) {
+			iterations = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (argument == "--fixture" && i + 1 < argc) {
+			fixture_path = argv[++i];
+		}
+		else if (argument == "--keep") {
+			keep_fixture = true;
+		}
+		else {
+			std::cerr << "Usage: gw2viewer-bench [--entries N] [--iterations N] [--fixture path.dat] [--keep]\n";
+			return 2;
+		}
+	}
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+		Fixture fixture = writeFixture(fixture_path, entry_count);
+		std::fprintf(stderr, "fixture: %u entries, %.1f MB, written in %.2f s\n", fixture.entries, fixture.bytes / 1e6, secondsSince(start));
+
+		std::vector<Measurement> measurements = runBenchmarks(fixture, iterations);
+
+		for (const Measurement& m : measurements) {
+			std::fprintf(stderr, "%-24s median %10.3f ms", m.name.c_str(), m.median_seconds * 1000.0);
+			if (m.bytes != 0) {
+				std::fprintf(stderr, "  %9.1f MB/s", m.bytes / 1e6 / m.median_seconds);
+			}
+			std::fprintf(stderr, "  %12.0f items/s\n", m.items / m.median_seconds);
+		}
+		printJson(fixture, iterations, measurements);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		if (!keep_fixture) {
+			removeFixture(fixture_path);
+		}
+		return 1;
+	}
+
+	if (!keep_fixture) {
+		removeFixture(fixture_path);
+	}
+
+	return 0;
+}
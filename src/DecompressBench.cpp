@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "DatCompress.h"
+#include "DatDecompress.h"
+
+// Microbenchmark for DatDecompressor::inflate on synthetic streams.
+// Usage: gw2viewer-decompress-bench [size_in_mib] [iterations]
+
+static std::vector<uint8_t> makeRandomData(size_t size, std::mt19937& rng) {
+	std::vector<uint8_t> data(size);
+	for (auto& byte : data) {
+		byte = static_cast<uint8_t>(rng());
+	}
+	return data;
+}
+
+static std::vector<uint8_t> makeTextData(size_t size, std::mt19937& rng) {
+	static const char* words[] = {
+		"guild", "wars", "tyria", "asura", "charr", "norn", "sylvari", "human", "dragon", "jade",
+		"sea", "lion's", "arch", "divinity's", "reach", "the", "of", "and", "a", "to",
+	};
+	std::vector<uint8_t> data;
+	data.reserve(size);
+	while (data.size() < size) {
+		const char* word = words[rng() % (sizeof(words) / sizeof(words[0]))];
+		data.insert(data.end(), word, word + std::strlen(word));
+		data.push_back(rng() % 8 == 0 ? '\n' : ' ');
+	}
+	data.resize(size);
+	return data;
+}
+
+// Vertex-like records: small float deltas with repeating structure
+static std::vector<uint8_t> makeStructuredData(size_t size, std::mt19937& rng) {
+	std::vector<uint8_t> data(size);
+	float value = 0.0f;
+	for (size_t i = 0; i + 16 <= size; i += 16) {
+		float record[4] = { value, value * 0.5f, 1.0f, static_cast<float>(i / 16 % 64) };
+		std::memcpy(data.data() + i, record, sizeof(record));
+		value += static_cast<float>(rng() % 4) * 0.25f;
+	}
+	return data;
+}
+
+static void runCase(const std::string& name, const std::vector<uint8_t>& data, int iterations) {
+	DatCompressor compressor;
+	std::vector<uint8_t> compressed = compressor.compress(data.data(), data.size());
+
+	DatDecompressor decompressor;
+	std::vector<uint8_t> output(DatDecompressor::readUncompressedSize(compressed.data(), compressed.size()));
+
+	size_t written = decompressor.inflate(compressed.data(), compressed.size(), output.data(), output.size(), false);
+	if (written != data.size() || output != data) {
+		std::cerr << name << ": round trip mismatch\n";
+		std::exit(1);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		decompressor.inflate(compressed.data(), compressed.size(), output.data(), output.size(), false);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	double megabytes = static_cast<double>(data.size()) * iterations / (1024.0 * 1024.0);
+	std::printf("%-12s %10zu -> %10zu bytes (%5.1f%%)  %9.1f MB/s\n", name.c_str(), data.size(), compressed.size(),
+		100.0 * compressed.size() / data.size(), megabytes / elapsed.count());
+}
+
+int main(int argc, char** argv) {
+	size_t size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16) * 1024 * 1024;
+	int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+	std::mt19937 rng(1234);
+	runCase("random", makeRandomData(size, rng), iterations);
+	runCase("text", makeTextData(size, rng), iterations);
+	runCase("structured", makeStructuredData(size, rng), iterations);
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+#include "DatDecompress.h"
+
+// Known-answer test for DatDecompressor. The stream below was assembled bit by bit from the
+// format description by a separate encoder, not by DatCompress.h, so a mistake mirrored between
+// datAssignCodes, the tree layout and the encoder cannot cancel out here.
+//
+// Header: size 320, copy length bias 3. One block:
+//   symbol tree  a:2  b,c:3  ' ',len0,len9:4  '\n',d,len28:5  Z,e:12 bits (285 symbols)
+//   copy tree    offset code 0:1  3,9:2 bits (34 symbols)
+//   codes        "abcd "  copy 3 @4  "\neZa"  copy 14 @1 (1 extra length bit)
+//                " abba cab dead bead\n"  copy 13 @30 (3 extra offset bits)  "Z\n"
+//                copy 258 @1 (length code 28)  "e"
+
+static const uint8_t KNOWN_STREAM[] = {
+	0x78, 0x56, 0x34, 0x12, 0x40, 0x01, 0x00, 0x00, 0x39, 0x1D, 0x01, 0x02, 0x1E, 0xF4, 0x34, 0x08,
+	0x42, 0x08, 0x21, 0x84, 0x08, 0x21, 0x84, 0x10, 0x20, 0x84, 0x10, 0x42, 0x0D, 0x2E, 0x38, 0xD6,
+	0x42, 0x08, 0xD9, 0x03, 0xE8, 0x49, 0x84, 0x10, 0x0D, 0x72, 0x26, 0x40, 0x10, 0x42, 0x22, 0x00,
+	0xD1, 0x60, 0x02, 0x0D, 0x21, 0x76, 0xD8, 0xA0, 0x1B, 0xBF, 0x49, 0xD9, 0xEF, 0xF6, 0xBB, 0xFE,
+	0xED, 0x37, 0xE8, 0x3A, 0x42, 0xFB, 0x4D, 0x0F, 0x49, 0x7F, 0x53, 0x54, 0x00, 0x00, 0xFC, 0xE6,
+};
+
+static std::string knownOutput() {
+	return "abcd bcd\neZa" + std::string(14, 'a') + " abba cab dead bead\n" + "aaaaaaaaaa ab" + "Z\n" +
+		std::string(258, '\n') + "e";
+}
+
+static bool check(const std::string& name, bool passed) {
+	std::cout << (passed ? "PASS " : "FAIL ") << name << "\n";
+	return passed;
+}
+
+// Whole stream in one call
+static bool testInflate() {
+	std::string expected = knownOutput();
+	if (DatDecompressor::readUncompressedSize(KNOWN_STREAM, sizeof(KNOWN_STREAM)) != expected.size()) {
+		return check("inflate: header size", false);
+	}
+
+	std::vector<uint8_t> output(expected.size());
+	DatDecompressor decompressor;
+	size_t written = decompressor.inflate(KNOWN_STREAM, sizeof(KNOWN_STREAM), output.data(), output.size(), false);
+	return check("inflate", written == expected.size() && std::string(output.begin(), output.end()) == expected);
+}
+
+// Small output ranges, so copies and literal pairs are cut at range ends
+static bool testPieces() {
+	std::string expected = knownOutput();
+	bool passed = true;
+	for (size_t piece = 1; piece <= 17; ++piece) {
+		std::vector<uint8_t> output(expected.size());
+		DatBitReader reader(KNOWN_STREAM, sizeof(KNOWN_STREAM), false);
+		DatDecompressor decompressor;
+		DatDecompressor::State state = DatDecompressor::begin(reader);
+		uint8_t* out = output.data();
+		while (!state.finished && out < output.data() + output.size()) {
+			uint8_t* out_end = std::min(out + piece, output.data() + output.size());
+			uint8_t* written = decompressor.decode(reader, state, output.data(), out, out_end);
+			if (written == out) {
+				break;
+			}
+			out = written;
+		}
+		passed &= state.finished && std::string(output.begin(), output.end()) == expected;
+	}
+	return check("decode in pieces", passed);
+}
+
+// A cut stream must fail, by throwing or by coming up short, never by padding the output
+static bool testTruncated() {
+	std::vector<uint8_t> output(knownOutput().size());
+	bool passed = true;
+	for (size_t cut = 12; cut < sizeof(KNOWN_STREAM); cut += 4) {
+		DatDecompressor decompressor;
+		try {
+			passed &= decompressor.inflate(KNOWN_STREAM, cut, output.data(), output.size(), false) < output.size();
+		}
+		catch (const std::runtime_error&) {
+		}
+	}
+	return check("truncated stream", passed);
+}
+
+int main() {
+	try {
+		bool passed = testInflate();
+		passed &= testPieces();
+		passed &= testTruncated();
+		return passed ? 0 : 1;
+	}
+	catch (const std::exception& e) {
+		std::cout << "FAIL " << e.what() << "\n";
+		return 1;
+	}
+}
@@ -1,28 +1,81 @@
 ﻿#include "GW2Viewer.h"
 #include "DatFile.h"
+#include "EntryLoader.h"
+#include "PreviewDecoder.h"
+#include "TextureDecoder.h"
+#include "HexView.h"
+#include "DatEntryStream.h"
+#include "DatClassifier.h"
+#include "PackFile.h"
+#include "DatSeekableEntry.h"
 
 static GLuint framebuffer = 0, texture = 0, depthbuffer = 0;
 static int fb_width = 0, fb_height = 0;
 static int find_number = 0;
 static int temp_number = 0;
-// Read the decompressed data buffer once
-static std::vector<uint8_t> decompressed_data;
-static std::vector<uint8_t> compressed_data;
 
-static int image_width = 0, image_height = 0, image_channels = 0;
-static unsigned char* image_data = nullptr;
 static GLuint texture_id = 0;
 
 
 GLuint shaderProgram;
 GLuint VAO, VBO;
-static std::vector<uint32_t> found_results;
+static DatSearchIndex::Results found_results;
 std::chrono::high_resolution_clock::time_point lastFrameTime = std::chrono::high_resolution_clock::now();
 float frameTime = 0.0f;
 int frameCount = 0;
 float fps = 0.0f;
 
 
+// Decodes ATEX-family textures and anything stb_image understands (PNG, JPEG, BMP, ...) to RGBA
+static PreviewSurface decodePreviewImage(const std::vector<uint8_t>& data) {
+	PreviewSurface surface;
+	if (TextureDecoder::isTexture(data.data(), data.size())) {
+		TextureDecoder::Header header;
+		surface.pixels = TextureDecoder::decode(data.data(), data.size(), header);
+		surface.width = header.width;
+		surface.height = header.height;
+		surface.format = std::string(header.magic, 4) + " " + std::string(header.format, 4);
+		return surface;
+	}
+
+	int channels = 0;
+	unsigned char* pixels = stbi_load_from_memory(data.data(), static_cast<int>(data.size()),
+		&surface.width, &surface.height, &channels, 4);
+	if (!pixels) {
+		surface.error = "Unsupported format or corrupted data.";
+		return surface;
+	}
+
+	surface.pixels.assign(pixels, pixels + static_cast<size_t>(surface.width) * surface.height * 4);
+	stbi_image_free(pixels);
+	surface.format = "Image, " + std::to_string(channels) + " channels";
+	return surface;
+}
+
+
+enum class PreviewKind {
+	None,
+	Image,
+	Model3D
+};
+
+// Unknown entries still go to stb_image, which knows formats the classifier does not sniff
+static PreviewKind previewKindOf(DatFileType type) {
+	switch (type) {
+	case DatFileType::Texture:
+	case DatFileType::Png:
+	case DatFileType::Jpeg:
+	case DatFileType::Unknown:
+	case DatFileType::Unclassified:
+		return PreviewKind::Image;
+	case DatFileType::Model:
+		return PreviewKind::Model3D;
+	default:
+		return PreviewKind::None;
+	}
+}
+
+
 class Application {
 public:
 	Application(int width, int height, const char* title)
@@ -35,7 +88,8 @@ public:
 		last_selected_item_decompressed(-1),
 		last_selected_item(-1),
 		selected_item(-1),
-		last_x(0), last_y(0), camera_zoom(45.0f), camera_angle_x(0.0f), camera_angle_y(0.0f) {
+		last_x(0), last_y(0), camera_zoom(45.0f), camera_angle_x(0.0f), camera_angle_y(0.0f),
+		startup_time(std::chrono::steady_clock::now()), load_time_ms(0.0f), first_frame_time_ms(0.0f) {
 
 		initGLFW();
 		createWindow();
@@ -60,15 +114,50 @@ public:
 			}
 
 			renderFrame();
+
+			if (first_frame_time_ms == 0.0f) {
+				first_frame_time_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startup_time).count();
+				std::cout << "Time to first frame: " << first_frame_time_ms << " ms (archive load " << load_time_ms << " ms)\n";
+				startCacheWrite();
+			}
 		}
 	}
 
 private:
+	static constexpr uint64_t SEEKABLE_SIZE = 16ull << 20;
+
 	int window_width, window_height;
 	const char* window_title;
 	ImVec4 clear_color;
 	std::unique_ptr<GLFWwindow, decltype(&glfwDestroyWindow)> context_window{ nullptr, glfwDestroyWindow };
 	std::unique_ptr<DatFile> dat_file; // Pointer to a DatFile object
+	std::unique_ptr<EntryLoader> entry_loader; // Reads entries off the UI thread
+	std::unique_ptr<DatClassifier> classifier; // Tags entries with their file type in the background
+	std::future<void> cache_write; // Sidecar cache for the next start; destroyed before dat_file, which waits for it
+	int type_filter = -1; // DatFileType shown in the left panel, -1 for all
+	std::vector<uint32_t> filtered_items;
+	bool filtered_items_stale = true;
+	size_t filtered_classified_count = 0;
+	int filtered_find_number = 0;
+	std::chrono::steady_clock::time_point filtered_items_time;
+	EntryLoader::Request compressed_request;
+	EntryLoader::Request decompressed_request;
+	EntryLoader::Request crc_request; // Verify Chunk CRCs, polled until it reports
+	int requested_item = -1;
+	std::unique_ptr<PreviewDecoder> preview_decoder; // Decodes preview images off the UI thread
+	std::shared_ptr<const PreviewSurface> preview_surface; // Pixels currently in texture_id
+	int preview_item = -1;
+	HexView compressed_view;
+	HexView decompressed_view;
+	HexView archive_view; // Raw .dat bytes with 64-bit offsets
+	bool show_archive_tab = false;
+	bool show_decompressed_tab = false;
+	std::unique_ptr<PackFile> pack_file; // Chunk table of the selected entry, into pack_file_data
+	std::shared_ptr<const std::vector<uint8_t>> pack_file_data;
+	std::string pack_file_error;
+	int pack_file_item = -1;
+	std::unique_ptr<DatSeekableEntry> seekable_entry; // Source of decompressed_view for large entries
+	int seekable_item = -1;
 	float status_message_timer;
 	std::string status_message;
 	int last_selected_item_decompressed;
@@ -80,19 +169,43 @@ private:
 	float camera_angle_x, camera_angle_y;
 	double last_x, last_y;
 
+	// Startup timing
+	std::chrono::steady_clock::time_point startup_time;
+	float load_time_ms;
+	float first_frame_time_ms;
+
 	void loadFile() {
 		//std::string file_path = "Local.dat";
 		std::string file_path = "C:\\Program Files (x86)\\Steam\\steamapps\\common\\Guild Wars 2\\Gw2.dat";
 
 		try {
+			auto load_start = std::chrono::steady_clock::now();
 			dat_file = std::make_unique<DatFile>(file_path);
-			std::cout << "Loaded DAT file: " << file_path << '\n';
+			entry_loader = std::make_unique<EntryLoader>(*dat_file);
+			preview_decoder = std::make_unique<PreviewDecoder>(decodePreviewImage);
+			classifier = std::make_unique<DatClassifier>(*dat_file);
+			classifier->start();
+			load_time_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+			std::cout << "Loaded DAT file: " << file_path << " in " << load_time_ms << " ms\n";
 		}
 		catch (const std::exception& e) {
 			std::cerr << "Failed to load DAT file: " << e.what() << '\n';
 		}
 	}
 
+	// Writing the cache builds the whole search index, so it waits until the archive is on screen
+	void startCacheWrite() {
+		if (!dat_file) {
+			return;
+		}
+		DatFile* file = dat_file.get();
+		cache_write = std::async(std::launch::async, [file] {
+			if (!file->writeCache()) {
+				std::cerr << "Failed to write MFT cache " << DatCache::pathFor(file->getFilename()) << '\n';
+			}
+		});
+	}
+
 	void initGLFW() {
 		glfwSetErrorCallback([](int error, const char* description) {
 			std::cerr << "GLFW Error " << error << ": " << description << '\n';
@@ -268,6 +381,7 @@ private:
 		//// Fixed search bar at the top
 		ImGui::Text("Search Bar:");
 		ImGui::InputInt("##SearchBar", &find_number);
+		renderTypeFilter();
 		ImGui::Separator();
 
 		ImGui::Text("MFT Data List:");
@@ -276,12 +390,33 @@ private:
 		ImVec2 child_size = ImVec2(0, 0); // Adjust height as needed
 		ImGui::BeginChild("MFTList", child_size, true, ImGuiWindowFlags_HorizontalScrollbar);
 
-		if (find_number > 0)
+		if (type_filter >= 0)
+		{
+			if (find_number > 0 && temp_number != find_number)
+			{
+				found_results = dat_file->searchMftData(find_number, true);
+				temp_number = find_number;
+			}
+			updateFilteredItems();
+
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(filtered_items.size()));
+			while (clipper.Step()) {
+				for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+					int mft_index = static_cast<int>(filtered_items[row]);
+					if (ImGui::Selectable(("MFT Entry " + std::to_string(mft_index)).c_str(), selected_item == mft_index) || (ImGui::IsItemFocused() && selected_item != mft_index)) {
+						selected_item = mft_index;
+					}
+				}
+			}
+			clipper.End();
+		}
+		else if (find_number > 0)
 		{
 
 			if (temp_number != find_number)
 			{
-				found_results = dat_file->findMftData(find_number, true);
+				found_results = dat_file->searchMftData(find_number, true);
 				temp_number = find_number;
 			}
 
@@ -292,9 +427,13 @@ private:
 			clipper.Begin(static_cast<int>(total_items)); // Total number of items in the list
 
 			while (clipper.Step()) {
-				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
-					if (ImGui::Selectable(("MFT Entry " + std::to_string(found_results[i])).c_str(), selected_item == found_results[i])) {
-						selected_item = found_results[i];
+				// Only the visible page of results is fetched
+				std::vector<uint32_t> page = found_results.page(clipper.DisplayStart, clipper.DisplayEnd - clipper.DisplayStart);
+				for (uint32_t mft_index : page) {
+					bool is_selected = selected_item == static_cast<int>(mft_index);
+					// Arrow keys move the selection along with the keyboard focus
+					if (ImGui::Selectable(("MFT Entry " + std::to_string(mft_index)).c_str(), is_selected) || (ImGui::IsItemFocused() && !is_selected)) {
+						selected_item = mft_index;
 					}
 				}
 			}
@@ -302,7 +441,7 @@ private:
 			clipper.End();
 		}
 
-		if (find_number == 0)
+		else if (find_number == 0)
 		{
 
 			const auto& mft_data = dat_file->getMftData();
@@ -314,7 +453,7 @@ private:
 
 			while (clipper.Step()) {
 				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
-					if (ImGui::Selectable(("MFT Entry " + std::to_string(i)).c_str(), selected_item == i)) {
+					if (ImGui::Selectable(("MFT Entry " + std::to_string(i)).c_str(), selected_item == i) || (ImGui::IsItemFocused() && selected_item != i)) {
 						selected_item = i;
 					}
 				}
@@ -328,124 +467,200 @@ private:
 		ImGui::End();
 	}
 
-	void renderCompressedTab() {
-		if (selected_item >= 0 && selected_item < dat_file->getMftData().size()) {
-			const auto& selected_entry = dat_file->getMftData()[selected_item];
+	// Type filter with the number of entries of each type classified so far
+	void renderTypeFilter() {
+		if (!classifier) {
+			return;
+		}
 
-			// Read the compressed data buffer once
-			if (selected_item != last_selected_item) {
-				compressed_data = dat_file->readCompressedData(selected_entry);
-				last_selected_item = selected_item;
+		auto label = [&](int type) {
+			if (type < 0) {
+				return std::string("All types");
 			}
+			DatFileType file_type = static_cast<DatFileType>(type);
+			return std::string(DatClassifier::typeName(file_type)) + " (" + std::to_string(classifier->getTypeCount(file_type)) + ")";
+		};
 
-			// Display compressed data
-			ImGui::Text("Compressed Data (Hex):");
-			ImGui::BeginChild("Compressed Scroll", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
-
-			ImGuiListClipper clipper;
-			clipper.Begin(static_cast<int>(compressed_data.size() / 16 + 1));
+		if (ImGui::BeginCombo("Type", label(type_filter).c_str())) {
+			for (int type = -1; type < static_cast<int>(DatFileType::Count); ++type) {
+				if (type >= 0 && classifier->getTypeCount(static_cast<DatFileType>(type)) == 0) {
+					continue;
+				}
+				if (ImGui::Selectable(label(type).c_str(), type_filter == type)) {
+					type_filter = type;
+					filtered_items_stale = true;
+				}
+			}
+			ImGui::EndCombo();
+		}
 
-			while (clipper.Step()) {
-				for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
-					uint64_t start_idx = static_cast<uint64_t>(line) * 16;
-					std::string line_str;
-
-					// Line number
-					char line_number[16];
-					snprintf(line_number, sizeof(line_number), "%08X: ", (unsigned int)start_idx);
-					line_str += line_number;
-
-					// Hexadecimal bytes
-					for (uint64_t j = 0; j < 16; ++j) {
-						if (start_idx + j < compressed_data.size()) {
-							char hex_byte[4];
-							snprintf(hex_byte, sizeof(hex_byte), "%02X ", compressed_data[start_idx + j]);
-							line_str += hex_byte;
-						}
-						else {
-							line_str += "   ";
-						}
-					}
+		if (!classifier->finished()) {
+			ImGui::TextDisabled("Classifying %zu/%zu entries...", classifier->getClassifiedCount(), classifier->getEntryCount());
+		}
+	}
 
-					// ASCII representation
-					line_str += " ";
-					for (uint64_t j = 0; j < 16; ++j) {
-						if (start_idx + j < compressed_data.size()) {
-							char c = compressed_data[start_idx + j];
-							line_str += (c >= 32 && c <= 126) ? c : '.';
-						}
-						else {
-							line_str += " ";
-						}
-					}
+	// Rebuilds the filtered list when the filter or search changes, and a few times a second
+	// while the classifier still tags entries
+	void updateFilteredItems() {
+		auto now = std::chrono::steady_clock::now();
+		size_t classified_count = classifier->getClassifiedCount();
+		if (find_number != filtered_find_number) {
+			filtered_items_stale = true;
+		}
+		if (!filtered_items_stale && (classified_count == filtered_classified_count ||
+			now - filtered_items_time < std::chrono::milliseconds(250))) {
+			return;
+		}
 
-					ImGui::TextUnformatted(line_str.c_str());
+		DatFileType file_type = static_cast<DatFileType>(type_filter);
+		filtered_items.clear();
+		if (find_number > 0) {
+			for (uint32_t mft_index : found_results.all()) {
+				if (classifier->getType(mft_index) == file_type) {
+					filtered_items.push_back(mft_index);
 				}
 			}
+		}
+		else {
+			for (uint32_t mft_index = 0; mft_index < classifier->getEntryCount(); ++mft_index) {
+				if (classifier->getType(mft_index) == file_type) {
+					filtered_items.push_back(mft_index);
+				}
+			}
+		}
 
-			clipper.End();
-			ImGui::EndChild();
+		filtered_items_stale = false;
+		filtered_find_number = find_number;
+		filtered_classified_count = classified_count;
+		filtered_items_time = now;
+	}
+
+	void renderCompressedTab() {
+		if (selected_item >= 0 && selected_item < dat_file->getMftData().size()) {
+			// Request the compressed data buffer once
+			if (selected_item != last_selected_item) {
+				compressed_request = entry_loader->request(selected_item, EntryLoader::Kind::Compressed);
+				last_selected_item = selected_item;
+			}
+
+			const std::vector<uint8_t>* loaded_data = pollEntryRequest(compressed_request);
+			if (!loaded_data) {
+				return;
+			}
+
+			// Display compressed data
+			ImGui::Text("Compressed Data (Hex):");
+			compressed_view.setBuffer(loaded_data->data(), loaded_data->size());
+			compressed_view.render("Compressed Scroll");
 		}
 	}
 
 	void renderDecompressedTab() {
 		if (selected_item >= 0 && selected_item < dat_file->getMftData().size()) {
-			const auto& selected_entry = dat_file->getMftData()[selected_item];
+			if (attachSeekableView()) {
+				ImGui::Text("Decompressed Data (Hex, %.0f%% indexed):",
+					100.0 * seekable_entry->getIndexedSize() / std::max<uint64_t>(seekable_entry->getSize(), 1));
+				std::string index_error = seekable_entry->getIndexError();
+				if (!index_error.empty()) {
+					ImGui::Text("Indexing stopped: %s", index_error.c_str());
+				}
+				decompressed_view.render("Decompressed Scroll");
+				return;
+			}
 
-			// Read the decompressed data buffer once
-			if (selected_item != last_selected_item_decompressed) {
-				decompressed_data = dat_file->removeCrc32Data(selected_entry);
-				dat_file->updateUncompressedSize(selected_item, decompressed_data.size());
-				last_selected_item_decompressed = selected_item;
+			const std::vector<uint8_t>* loaded_data = pollDecompressedData();
+			if (!loaded_data) {
+				return;
 			}
+
 			// Display decompressed data
 			ImGui::Text("Decompressed Data (Hex):");
-			ImGui::BeginChild("Decompressed Scroll", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+			decompressed_view.setBuffer(loaded_data->data(), loaded_data->size());
+			decompressed_view.render("Decompressed Scroll");
+		}
+	}
 
-			ImGuiListClipper clipper;
-			clipper.Begin(static_cast<int>(decompressed_data.size() / 16 + 1));
+	// Entries of SEEKABLE_SIZE and up are decoded a page at a time as they scroll into view, from
+	// checkpoints indexed in the background, instead of waiting for the whole entry. False for
+	// smaller entries, which load whole.
+	bool attachSeekableView() {
+		if (seekable_item == selected_item) {
+			return seekable_entry != nullptr;
+		}
 
-			while (clipper.Step()) {
-				for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
-					uint64_t start_idx = static_cast<uint64_t>(line) * 16;
-					std::string line_str;
-
-					// Line number
-					char line_number[16];
-					snprintf(line_number, sizeof(line_number), "%08X: ", (unsigned int)start_idx);
-					line_str += line_number;
-
-					// Hexadecimal bytes
-					for (uint64_t j = 0; j < 16; ++j) {
-						if (start_idx + j < decompressed_data.size()) {
-							char hex_byte[4];
-							snprintf(hex_byte, sizeof(hex_byte), "%02X ", decompressed_data[start_idx + j]);
-							line_str += hex_byte;
-						}
-						else {
-							line_str += "   ";
-						}
-					}
+		seekable_item = selected_item;
+		if (seekable_entry) {
+			decompressed_view.setBuffer(nullptr, 0);
+			seekable_entry.reset();
+		}
+		const DatFile::MftData& entry = dat_file->getMftData()[selected_item];
+		try {
+			uint64_t size = entry.compression_flag != 0 ? dat_file->readUncompressedSize(entry) : entry.size;
+			if (size < SEEKABLE_SIZE) {
+				return false;
+			}
+			seekable_entry = std::make_unique<DatSeekableEntry>(*dat_file, selected_item);
+		}
+		catch (const std::exception&) {
+			// The whole load reports the error
+			return false;
+		}
 
-					// ASCII representation
-					line_str += " ";
-					for (uint64_t j = 0; j < 16; ++j) {
-						if (start_idx + j < decompressed_data.size()) {
-							char c = decompressed_data[start_idx + j];
-							line_str += (c >= 32 && c <= 126) ? c : '.';
-						}
-						else {
-							line_str += " ";
-						}
-					}
+		seekable_entry->startIndexing();
+		DatSeekableEntry* seekable = seekable_entry.get();
+		decompressed_view.setSource(seekable->getSize(), [seekable](uint64_t offset, uint8_t* buffer, size_t length) {
+			return seekable->tryRead(offset, buffer, length);
+		});
+		return true;
+	}
 
-					ImGui::TextUnformatted(line_str.c_str());
-				}
-			}
+	// The whole .dat file, paged in as it scrolls into view
+	void attachArchiveView() {
+		if (archive_view.getSize() != dat_file->getFileSize()) {
+			archive_view.setSource(dat_file->getFileSize(), [this](uint64_t offset, uint8_t* buffer, size_t length) {
+				dat_file->readRaw(offset, buffer, length);
+				return true;
+			});
+		}
+	}
 
-			clipper.End();
-			ImGui::EndChild();
+	void renderArchiveTab() {
+		if (!dat_file) {
+			return;
+		}
+
+		attachArchiveView();
+		ImGui::Text("Archive Data (Hex):");
+		archive_view.render("Archive Scroll");
+	}
+
+	// Shows the state of a pending load; returns the entry data once it has arrived
+	const std::vector<uint8_t>* pollEntryRequest(const EntryLoader::Request& request) {
+		if (!request.ready()) {
+			ImGui::Text("Loading MFT Entry %u...", request.getMftIndex());
+			return nullptr;
+		}
+
+		const EntryLoader::Result& result = request.get();
+		if (!result.data) {
+			ImGui::Text("Failed to load MFT Entry %u: %s", request.getMftIndex(), result.error.c_str());
+			return nullptr;
+		}
+		return result.data.get();
+	}
+
+	// Decompressed data shared by the Decompressed and Preview tabs
+	const std::vector<uint8_t>* pollDecompressedData() {
+		if (selected_item != last_selected_item_decompressed) {
+			decompressed_request = entry_loader->request(selected_item, EntryLoader::Kind::Decompressed);
+			last_selected_item_decompressed = selected_item;
 		}
+
+		const std::vector<uint8_t>* loaded_data = pollEntryRequest(decompressed_request);
+		if (loaded_data && dat_file->getMftData()[selected_item].uncompressed_size != loaded_data->size()) {
+			dat_file->updateUncompressedSize(selected_item, static_cast<uint32_t>(loaded_data->size()));
+		}
+		return loaded_data;
 	}
 
 	void createFramebuffer(GLuint& framebuffer, GLuint& texture, GLuint& depthbuffer, int width, int height) {
@@ -585,69 +800,72 @@ private:
 
 	void renderPreviewTab() {
 		if (selected_item >= 0 && selected_item < dat_file->getMftData().size()) {
-			const auto& selected_entry = dat_file->getMftData()[selected_item];
-
 			// Display preview data
 			ImGui::Text("Preview Data:");
-			std::string file_type = "Image";
 
+			const std::vector<uint8_t>* loaded_data = pollDecompressedData();
+			if (!loaded_data) {
+				return;
+			}
+			const std::vector<uint8_t>& decompressed_data = *loaded_data;
 
+			// The loaded data settles the type of entries the background scan has not reached yet
+			classifier->classifyData(selected_item, decompressed_data.data(), decompressed_data.size());
+			DatFileType file_type = classifier->getType(selected_item);
+			PreviewKind preview_kind = previewKindOf(file_type);
+			ImGui::Text("Type: %s", DatClassifier::typeName(file_type));
 
-			if (selected_item != last_selected_item_decompressed) {
-				// Decompress the data and update uncompressed size
-				decompressed_data = dat_file->removeCrc32Data(selected_entry);
-				dat_file->updateUncompressedSize(selected_item, decompressed_data.size());
-				last_selected_item_decompressed = selected_item;
+			if (preview_kind == PreviewKind::None)
+			{
+				ImGui::Text("No preview for this type.");
 			}
 
-			if (file_type == "Image")
+			if (preview_kind == PreviewKind::Image)
 			{
-
-				// Free the previous image data if it exists
-				if (image_data) {
-					stbi_image_free(image_data);
-					image_data = nullptr;
+				// Decode once per selection, on the preview worker
+				if (preview_item != selected_item) {
+					preview_decoder->submit(selected_item, decompressed_request.get().data);
+					preview_item = selected_item;
+					preview_surface.reset();
 				}
 
-				// Attempt to load the decompressed data as an image
-				image_data = stbi_load_from_memory(
-					decompressed_data.data(),
-					static_cast<int>(decompressed_data.size()),
-					&image_width,
-					&image_height,
-					&image_channels,
-					0 // Keep original channels
-				);
-
-				if (image_data) {
-					ImGui::Text("Image loaded successfully!");
-					ImGui::Text("Dimensions: %dx%d, Channels: %d", image_width, image_height, image_channels);
-				}
-				else {
-					ImGui::Text("Failed to load image. Unsupported format or corrupted data.");
-				}
+				uint32_t decoded_item = 0;
+				std::shared_ptr<const PreviewSurface> decoded_surface;
+				if (preview_decoder->poll(decoded_item, decoded_surface) && static_cast<int>(decoded_item) == preview_item) {
+					preview_surface = decoded_surface;
 
-				// If the image is successfully loaded, display it
-				if (image_data) {
+					// Upload only when new pixels arrive
+					if (preview_surface->valid()) {
+						if (texture_id == 0) {
+							glGenTextures(1, &texture_id);
+						}
 
-					// Create an OpenGL texture for displaying the image
-					if (texture_id == 0) {
-						glGenTextures(1, &texture_id);
+						glBindTexture(GL_TEXTURE_2D, texture_id);
+						glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, preview_surface->width, preview_surface->height, 0,
+							GL_RGBA, GL_UNSIGNED_BYTE, preview_surface->pixels.data());
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 					}
+				}
 
-					glBindTexture(GL_TEXTURE_2D, texture_id);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0,
-						(image_channels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, image_data);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				if (!preview_surface) {
+					ImGui::Text("Decoding preview...");
+				}
+				else if (!preview_surface->valid()) {
+					ImGui::Text("Failed to load image. %s", preview_surface->error.c_str());
+				}
+				else {
+					ImGui::Text("Image loaded successfully!");
+					ImGui::Text("Dimensions: %dx%d, Format: %s", preview_surface->width, preview_surface->height, preview_surface->format.c_str());
 
 					// Display the texture in ImGui
 					ImGui::Image((ImTextureID)texture_id,
-						ImVec2(image_width, image_height));
+						ImVec2(preview_surface->width, preview_surface->height));
 				}
 			}
 
-			if (file_type == "Model3D")
+			if (preview_kind == PreviewKind::Model3D)
 			{
 
 				// Reserve space for FPS and other info (e.g., 90px for FPS display)
@@ -675,27 +893,23 @@ private:
 					createFramebuffer(framebuffer, texture, depthbuffer, fb_width, fb_height);
 				}
 
-				std::string fileType = "Model3D";
-				if (fileType == "Model3D") {
-					// Calculate FPS and frame time
-					auto currentFrameTime = std::chrono::high_resolution_clock::now();
-					std::chrono::duration<float> deltaTime = currentFrameTime - lastFrameTime;
-					lastFrameTime = currentFrameTime;
-					frameTime = deltaTime.count();
-					frameCount++;
-
-					if (frameCount >= 60) { // Update FPS every 60 frames
-						fps = 1.0f / frameTime;
-						frameCount = 0;
-					}
+				// Calculate FPS and frame time
+				auto currentFrameTime = std::chrono::high_resolution_clock::now();
+				std::chrono::duration<float> deltaTime = currentFrameTime - lastFrameTime;
+				lastFrameTime = currentFrameTime;
+				frameTime = deltaTime.count();
+				frameCount++;
 
-					// Render to framebuffer
-					renderToFramebuffer(framebuffer, fb_width, fb_height, camera_angle_x, camera_angle_y, camera_zoom);
+				if (frameCount >= 60) { // Update FPS every 60 frames
+					fps = 1.0f / frameTime;
+					frameCount = 0;
+				}
 
-					// Display framebuffer texture in ImGui
-					ImGui::Image((ImTextureID)texture, ImVec2(fb_width, fb_height), ImVec2(0, 1), ImVec2(1, 0));
+				// Render to framebuffer
+				renderToFramebuffer(framebuffer, fb_width, fb_height, camera_angle_x, camera_angle_y, camera_zoom);
 
-				}
+				// Display framebuffer texture in ImGui
+				ImGui::Image((ImTextureID)texture, ImVec2(fb_width, fb_height), ImVec2(0, 1), ImVec2(1, 0));
 
 				ImGui::EndChild();
 
@@ -725,13 +939,19 @@ private:
 	void renderMiddlePanel() {
 		ImGui::Begin("Extracted Data");
 
+		// Loads queued for the previous selection are no longer wanted
+		if (entry_loader && selected_item != requested_item) {
+			entry_loader->cancelPending();
+			requested_item = selected_item;
+		}
+
 		if (ImGui::BeginTabBar("MFT Data Tabs")) {
 			if (ImGui::BeginTabItem("Compressed")) {
 				renderCompressedTab();
 				ImGui::EndTabItem();
 			}
 
-			if (ImGui::BeginTabItem("Decompressed")) {
+			if (ImGui::BeginTabItem("Decompressed", nullptr, show_decompressed_tab ? ImGuiTabItemFlags_SetSelected : 0)) {
 				renderDecompressedTab();
 				ImGui::EndTabItem();
 			}
@@ -741,6 +961,13 @@ private:
 				ImGui::EndTabItem();
 			}
 
+			if (ImGui::BeginTabItem("Archive", nullptr, show_archive_tab ? ImGuiTabItemFlags_SetSelected : 0)) {
+				renderArchiveTab();
+				ImGui::EndTabItem();
+			}
+			show_archive_tab = false;
+			show_decompressed_tab = false;
+
 			ImGui::EndTabBar();
 		}
 
@@ -755,6 +982,10 @@ private:
 
 		ImGui::Text("Filename: %s", dat_file->getFilename().c_str());
 		ImGui::Text("File Size: %llu bytes", dat_file->getFileSize());
+		ImGui::Text("Read Mode: %s", dat_file->isMapped() ? "Memory Mapped" : "Stream");
+		ImGui::Text("MFT Source: %s", dat_file->isLoadedFromCache() ? "Cache" : "Archive");
+		ImGui::Text("Load Time: %.1f ms", load_time_ms);
+		ImGui::Text("Time To First Frame: %.1f ms", first_frame_time_ms);
 		ImGui::Text("Version: %d", header.version);
 		ImGui::Text("Chunk Size: %u bytes", header.chunk_size);
 		ImGui::Text("MFT Offset: %llu", header.mft_offset);
@@ -768,6 +999,24 @@ private:
 	}
 
 
+	void renderEntryCacheInformation() {
+		EntryCache& cache = entry_loader->getCache();
+		EntryCache::Stats stats = cache.getStats();
+		uint64_t lookups = stats.hits + stats.misses;
+
+		ImGui::Separator();
+		ImGui::Text("Entry Cache:");
+		ImGui::Text("Entries: %zu (%.1f / %.1f MiB)", stats.entries, stats.bytes / 1048576.0, stats.byte_budget / 1048576.0);
+		ImGui::Text("Hits: %llu, Misses: %llu (%.0f%% hit rate)", static_cast<unsigned long long>(stats.hits),
+			static_cast<unsigned long long>(stats.misses), lookups ? 100.0 * stats.hits / lookups : 0.0);
+		ImGui::Text("Evictions: %llu", static_cast<unsigned long long>(stats.evictions));
+
+		int budget_mib = static_cast<int>(stats.byte_budget >> 20);
+		if (ImGui::SliderInt("Budget (MiB)", &budget_mib, 16, 4096)) {
+			cache.setByteBudget(static_cast<uint64_t>(budget_mib) << 20);
+		}
+	}
+
 	void renderSelectedMftEntryInformation() {
 		const auto& selected_entry = dat_file->getMftData()[selected_item];
 
@@ -780,12 +1029,19 @@ private:
 		ImGui::Text("Counter: %u", selected_entry.counter);
 		ImGui::Text("CRC: %u", selected_entry.crc);
 		ImGui::Text("Uncompressed Size: %u", selected_entry.uncompressed_size);
+		ImGui::Text("Type: %s", DatClassifier::typeName(classifier->getType(selected_item)));
+		ImGui::Text("Chunk CRCs: %zu", selected_entry.crc_32c_data.size());
+
+		if (ImGui::Button("Show in Archive")) {
+			attachArchiveView();
+			archive_view.jumpTo(selected_entry.offset);
+			show_archive_tab = true;
+		}
 
 		if (ImGui::Button("Export Compressed Data")) {
 			try {
-				compressed_data = dat_file->readCompressedData(selected_entry);
 				std::string filename = "compressed_" + std::to_string(selected_item) + ".bin";
-				exportDataToFile(filename, compressed_data);
+				exportEntryToFile(filename, false);
 				status_message = "Compressed data exported to " + filename;
 				status_message_timer = 3.0f; // Show the message for 3 seconds
 			}
@@ -797,10 +1053,8 @@ private:
 
 		if (ImGui::Button("Export Decompressed Data")) {
 			try {
-
-				decompressed_data = dat_file->removeCrc32Data(selected_entry);
 				std::string filename = "decompressed_" + std::to_string(selected_item) + ".bin";
-				exportDataToFile(filename, decompressed_data);
+				exportEntryToFile(filename, true);
 				status_message = "Decompressed data exported to " + filename;
 				status_message_timer = 5.0f;
 			}
@@ -809,6 +1063,111 @@ private:
 				status_message_timer = 5.0f;
 			}
 		}
+
+		// Checked on the loader thread, a large entry takes a while
+		if (crc_request.valid()) {
+			if (crc_request.ready()) {
+				const EntryLoader::Result& result = crc_request.get();
+				if (result.data) {
+					dat_file->setCrc32cData(crc_request.getMftIndex(), *result.data);
+					status_message = "All " + std::to_string(result.data->size() / 4) + " chunk CRCs of entry " +
+						std::to_string(crc_request.getMftIndex()) + " match";
+				}
+				else {
+					status_message = "Error: " + result.error;
+				}
+				status_message_timer = 5.0f;
+				crc_request = EntryLoader::Request();
+			}
+			else {
+				ImGui::Text("Verifying chunk CRCs of entry %u...", crc_request.getMftIndex());
+			}
+		}
+		else if (ImGui::Button("Verify Chunk CRCs")) {
+			crc_request = entry_loader->request(selected_item, EntryLoader::Kind::ChunkCrcs);
+		}
+	}
+
+	// Chunk tree of PF entries, built from the decompressed data once the section is opened
+	void renderPackFileChunks() {
+		switch (classifier->getType(selected_item)) {
+		case DatFileType::Model:
+		case DatFileType::Map:
+		case DatFileType::Material:
+		case DatFileType::AudioPackFile:
+		case DatFileType::PackFile:
+			break;
+		default:
+			return;
+		}
+
+		ImGui::Separator();
+		if (!ImGui::CollapsingHeader("PackFile Chunks")) {
+			return;
+		}
+
+		const std::vector<uint8_t>* loaded_data = pollDecompressedData();
+		if (!loaded_data) {
+			return;
+		}
+
+		if (pack_file_item != selected_item) {
+			pack_file.reset();
+			pack_file_error.clear();
+			pack_file_data = decompressed_request.get().data;
+			pack_file_item = selected_item;
+			try {
+				pack_file = std::make_unique<PackFile>(ByteSpan(pack_file_data->data(), pack_file_data->size()));
+			}
+			catch (const std::exception& e) {
+				pack_file_error = e.what();
+			}
+		}
+
+		if (!pack_file) {
+			ImGui::Text("Failed to read packfile: %s", pack_file_error.c_str());
+			return;
+		}
+
+		const auto& chunks = pack_file->getChunks();
+		ImGui::Text("Type: %s, %zu chunks", pack_file->typeName().c_str(), chunks.size());
+		if (!pack_file->getError().empty()) {
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", pack_file->getError().c_str());
+		}
+
+		for (size_t i = 0; i < chunks.size(); ++i) {
+			const PackFile::Chunk& chunk = chunks[i];
+			ImGui::PushID(static_cast<int>(i));
+			if (ImGui::TreeNode("Chunk", "%s v%u (%zu bytes)", chunk.typeName().c_str(), chunk.version, chunk.data.size)) {
+				renderPackFileChunk(chunk);
+				ImGui::TreePop();
+			}
+			ImGui::PopID();
+		}
+	}
+
+	// Only expanded chunks are formatted, a few lines of their payload
+	void renderPackFileChunk(const PackFile::Chunk& chunk) {
+		ImGui::Text("Offset: %llu", static_cast<unsigned long long>(chunk.offset));
+		ImGui::Text("Header Size: %u", chunk.header_size);
+		ImGui::Text("Descriptor Offset: %u", chunk.descriptor_offset);
+
+		if (ImGui::Button("Show in Decompressed")) {
+			decompressed_view.setBuffer(pack_file_data->data(), pack_file_data->size());
+			decompressed_view.jumpTo(chunk.offset);
+			show_decompressed_tab = true;
+		}
+
+		const size_t preview_lines = 4;
+		uint64_t payload_offset = chunk.offset + chunk.header_size;
+		int offset_digits = HexView::offsetDigits(pack_file_data->size());
+		char line[HexView::MAX_LINE_LENGTH];
+		for (size_t row = 0; row < preview_lines && row * HexView::BYTES_PER_LINE < chunk.data.size; ++row) {
+			size_t start = row * HexView::BYTES_PER_LINE;
+			int count = static_cast<int>(std::min(static_cast<size_t>(HexView::BYTES_PER_LINE), chunk.data.size - start));
+			size_t length = HexView::formatLine(chunk.data.data + start, count, payload_offset + start, offset_digits, line);
+			ImGui::TextUnformatted(line, line + length);
+		}
 	}
 
 	void renderStatusMessage() {
@@ -833,10 +1192,12 @@ private:
 
 			// Render file header information
 			renderFileHeaderInformation();
+			renderEntryCacheInformation();
 
 			// Render selected MFT entry information if an entry is selected
 			if (selected_item >= 0 && selected_item < dat_file->getMftData().size()) {
 				renderSelectedMftEntryInformation();
+				renderPackFileChunks();
 			}
 			else {
 				ImGui::Text("No MFT entry selected.");
@@ -857,13 +1218,30 @@ private:
 	}
 
 
-	void exportDataToFile(const std::string& filename, const std::vector<uint8_t>& data) {
+	// Writes the cached decompressed buffer when the entry is already loaded; otherwise
+	// streams it from the archive, so entries of any size export in constant memory
+	void exportEntryToFile(const std::string& filename, bool decompress) {
 		std::ofstream file(filename, std::ios::binary);
 		if (!file) {
 			throw std::runtime_error("Failed to open file for writing: " + filename);
 		}
-		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		EntryCache::Data cached;
+		if (decompress && entry_loader) {
+			cached = entry_loader->getCache().find(static_cast<uint32_t>(selected_item));
+		}
+		if (cached) {
+			file.write(reinterpret_cast<const char*>(cached->data()), cached->size());
+		}
+		else {
+			DatEntryStream stream(*dat_file, dat_file->getMftData()[selected_item], decompress);
+			for (ByteSpan span = stream.next(); !span.empty(); span = stream.next()) {
+				file.write(reinterpret_cast<const char*>(span.data), span.size);
+			}
+		}
 		file.close();
+		if (!file) {
+			throw std::runtime_error("Failed to write file: " + filename);
+		}
 	}
 
 
@@ -0,0 +1,596 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include "DatFile.h"
+#include "DatExtractor.h"
+#include "DatVerifier.h"
+#include "DatGenerator.h"
+#include "DatClassifier.h"
+#include "DatReadScheduler.h"
+#include "DatSeekableEntry.h"
+
+// Headless front end sharing the DatFile core with the viewer, for batch jobs and
+// throughput checks on machines without a GPU or display.
+
+static void printUsage() {
+	std::cerr <<
+		"Usage: gw2viewer-cli <command> <file.dat> [options]\n"
+		"\n"
+		"Commands:\n"
+		"  info                      Print the DAT and MFT headers\n"
+		"  list                      Print MFT entries (tab separated)\n"
+		"      --offset N            First entry to print (default 0)\n"
+		"      --count N             Number of entries to print (default all)\n"
+		"  extract                   Extract entries to a directory\n"
+		"      --out DIR             Output directory (default extracted)\n"
+		"      --index N             Extract a single entry\n"
+		"      --threads N           Worker threads (default one per core)\n"
+		"      --budget MIB          Entry data held in memory (default 512)\n"
+		"      --raw                 Keep entries compressed\n"
+		"      --no-resume           Ignore the journal of a previous run\n"
+		"  verify                    Check every entry's chunk CRCs, in offset order\n"
+		"      --threads N           Worker threads (default one per core)\n"
+		"      --budget MIB          Raw data held in memory in stream mode (default 256)\n"
+		"      --uring               Read stream batches through io_uring instead of positional reads\n"
+		"  classify                  Count entries by file type, sniffed from their first bytes\n"
+		"      --threads N           Worker threads (default one per core)\n"
+		"  peek <index>              Hex dump the start of an entry, decompressed, reading no more than needed\n"
+		"      --bytes N             Number of bytes (default 64)\n"
+		"      --offset N            Start at decompressed offset N, decoding from the nearest checkpoint\n"
+		"                            kept in the cache directory under checkpoints/\n"
+		"  search <number>           Find entries whose base_id contains number\n"
+		"      --file-id             Match file_ids instead of base_ids\n"
+		"      --exact               Exact match instead of substring\n"
+		"      --offset N, --count N Page of results to print (default first 100)\n"
+		"  bench                     Time reading and decompressing entries\n"
+		"      --count N             Number of entries, in offset order (default all)\n"
+		"                            With --stream, also times batched io_uring reads where available\n"
+		"  generate                  Write a synthetic archive to <file.dat> for scale tests\n"
+		"      --entries N           Number of entries (default 1000000)\n"
+		"      --mean-size BYTES     Mean entry payload size (default 4096)\n"
+		"      --compressed PERCENT  Share of compressed entries (default 25)\n"
+		"      --seed N              Random seed; equal options give identical files (default 1)\n"
+		"  startup                   Time opening the archive (MFT and index table parse)\n"
+		"      --iterations N        Number of timed loads per read mode (default 10)\n"
+		"\n"
+		"Global options:\n"
+		"  --stream                  Read with positional file reads instead of a memory mapping\n"
+		"  --no-cache                Parse the MFT from the archive, ignoring the cache and checkpoints\n"
+		"\n"
+		"Caches are kept in $GW2VIEWER_CACHE_DIR, or else the per-user cache directory\n"
+		"(%LOCALAPPDATA%\\GW2Viewer\\Cache, $XDG_CACHE_HOME/gw2viewer or ~/.cache/gw2viewer).\n"
+		"Checkpoints there are capped at 256 MiB in total; the least recently used go first.\n";
+}
+
+// Parsed "--name value" and "--flag" options plus positional arguments
+class CommandLine {
+public:
+	CommandLine(int argc, char** argv) {
+		for (int i = 1; i < argc; ++i) {
+			std::string argument = argv[i];
+			if (argument.compare(0, 2, "--") != 0) {
+				positionals.push_back(argument);
+				continue;
+			}
+
+			std::string name = argument.substr(2);
+			if (isFlag(name) || i + 1 >= argc) {
+				options[name] = "";
+			}
+			else {
+				options[name] = argv[++i];
+			}
+		}
+	}
+
+	bool has(const std::string& name) const {
+		return options.count(name) != 0;
+	}
+
+	std::string get(const std::string& name, const std::string& fallback) const {
+		auto it = options.find(name);
+		return it != options.end() ? it->second : fallback;
+	}
+
+	uint64_t getNumber(const std::string& name, uint64_t fallback) const {
+		auto it = options.find(name);
+		if (it == options.end()) {
+			return fallback;
+		}
+		char* end = nullptr;
+		uint64_t value = std::strtoull(it->second.c_str(), &end, 10);
+		if (it->second.empty() || *end != '\0') {
+			throw std::invalid_argument("Option --" + name + " expects a number");
+		}
+		return value;
+	}
+
+	const std::vector<std::string>& getPositionals() const {
+		return positionals;
+	}
+
+private:
+	std::map<std::string, std::string> options;
+	std::vector<std::string> positionals;
+
+	static bool isFlag(const std::string& name) {
+		return name == "raw" || name == "no-resume" || name == "file-id" || name == "exact" || name == "stream" ||
+			name == "no-cache" || name == "uring";
+	}
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void runInfo(DatFile& dat_file) {
+	dat_file.printSummary();
+	std::cout << "Read Mode: " << (dat_file.isMapped() ? "Memory Mapped" : "Stream") << "\n"
+		<< "MFT Source: " << (dat_file.isLoadedFromCache() ? "Cache" : "Archive") << "\n"
+		<< "MFT Entries Loaded: " << dat_file.getMftData().size() << "\n";
+}
+
+static void runList(DatFile& dat_file, const CommandLine& command_line) {
+	const auto& mft_data = dat_file.getMftData();
+	uint64_t first = std::min<uint64_t>(command_line.getNumber("offset", 0), mft_data.size());
+	uint64_t last = std::min<uint64_t>(first + command_line.getNumber("count", mft_data.size()), mft_data.size());
+
+	std::cout << "index\toffset\tsize\tcompression_flag\tentry_flag\tcounter\tcrc\n";
+	for (uint64_t i = first; i < last; ++i) {
+		const auto& entry = mft_data[i];
+		std::cout << i << '\t' << entry.offset << '\t' << entry.size << '\t' << entry.compression_flag << '\t'
+			<< entry.entry_flag << '\t' << entry.counter << '\t' << entry.crc << '\n';
+	}
+}
+
+static void runExtract(DatFile& dat_file, const CommandLine& command_line) {
+	DatExtractor::Options options;
+	options.output_directory = command_line.get("out", options.output_directory);
+	options.thread_count = static_cast<size_t>(command_line.getNumber("threads", 0));
+	options.memory_budget = command_line.getNumber("budget", options.memory_budget >> 20) << 20;
+	options.decompress = !command_line.has("raw");
+	options.resume = !command_line.has("no-resume");
+
+	DatExtractor extractor(dat_file, options);
+
+	if (command_line.has("index")) {
+		uint64_t index = command_line.getNumber("index", 0);
+		if (index >= dat_file.getMftData().size()) {
+			throw std::out_of_range("MFT index out of range: " + std::to_string(index));
+		}
+		DatEntryStream stream(dat_file, dat_file.getMftData()[index], options.decompress);
+		std::string path = extractor.entryPath(static_cast<uint32_t>(index));
+		std::ofstream output(path, std::ios::binary);
+		for (ByteSpan span = stream.next(); !span.empty() && output; span = stream.next()) {
+			output.write(reinterpret_cast<const char*>(span.data), span.size);
+		}
+		if (!output) {
+			throw std::runtime_error("Failed to write file: " + path);
+		}
+		std::cout << "Wrote " << stream.getPosition() << " bytes to " << path << "\n";
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	extractor.run([&](const DatExtractor::Progress& progress) {
+		uint64_t processed = progress.entries_done + progress.entries_skipped + progress.entries_failed;
+		double seconds = secondsSince(start);
+		std::fprintf(stderr, "\r%llu/%llu entries, %.1f MB written, %.1f MB/s read    ",
+			static_cast<unsigned long long>(processed), static_cast<unsigned long long>(progress.entries_total),
+			progress.bytes_written / 1e6, seconds > 0 ? progress.bytes_read / 1e6 / seconds : 0.0);
+	});
+	std::fprintf(stderr, "\n");
+
+	const auto& progress = extractor.getProgress();
+	std::cout << "Extracted " << progress.entries_done << " entries (" << progress.entries_skipped << " already done, "
+		<< progress.entries_failed << " failed) in " << secondsSince(start) << " s\n";
+	for (const auto& failure : extractor.getFailures()) {
+		std::cerr << "Entry " << failure.mft_index << ": " << failure.message << "\n";
+	}
+}
+
+static void runClassify(DatFile& dat_file, const CommandLine& command_line) {
+	DatClassifier classifier(dat_file, static_cast<size_t>(command_line.getNumber("threads", 0)));
+	auto start = std::chrono::steady_clock::now();
+	classifier.start();
+	classifier.wait();
+	double seconds = secondsSince(start);
+
+	std::cout << "type\tentries\n";
+	for (int type = 0; type < static_cast<int>(DatFileType::Count); ++type) {
+		size_t count = classifier.getTypeCount(static_cast<DatFileType>(type));
+		if (count != 0) {
+			std::cout << DatClassifier::typeName(static_cast<DatFileType>(type)) << '\t' << count << '\n';
+		}
+	}
+	std::cout << "Classified " << classifier.getClassifiedCount() << " entries in " << seconds << " s\n";
+}
+
+// Returns false when any entry is corrupt or unreadable
+static bool runVerify(DatFile& dat_file, const CommandLine& command_line) {
+	DatVerifier::Options options;
+	options.thread_count = static_cast<size_t>(command_line.getNumber("threads", 0));
+	options.memory_budget = command_line.getNumber("budget", options.memory_budget >> 20) << 20;
+	options.use_io_uring = command_line.has("uring");
+
+	DatVerifier verifier(dat_file, options);
+	auto start = std::chrono::steady_clock::now();
+	verifier.run([&](const DatVerifier::Progress& progress) {
+		double seconds = secondsSince(start);
+		std::fprintf(stderr, "\r%.1f/%.1f GB, %llu corrupt, %.2f GB/s    ", progress.bytes_read / 1e9, progress.bytes_total / 1e9,
+			static_cast<unsigned long long>(progress.entries_corrupt), seconds > 0 ? progress.bytes_read / 1e9 / seconds : 0.0);
+	});
+	std::fprintf(stderr, "\n");
+	double seconds = secondsSince(start);
+
+	const auto& progress = verifier.getProgress();
+	for (const auto& failure : verifier.getFailures()) {
+		std::cout << (failure.corrupt ? "CORRUPT" : "UNREADABLE") << '\t' << failure.mft_index << '\t'
+			<< failure.offset << '\t' << failure.message << '\n';
+	}
+	std::printf("Verified %llu entries (%.2f GB) in %.3f s, %.2f GB/s: %llu ok, %llu corrupt, %llu unreadable\n",
+		static_cast<unsigned long long>(progress.entries_total), progress.bytes_read / 1e9, seconds,
+		seconds > 0 ? progress.bytes_read / 1e9 / seconds : 0.0, static_cast<unsigned long long>(progress.entries_done),
+		static_cast<unsigned long long>(progress.entries_corrupt), static_cast<unsigned long long>(progress.entries_failed));
+	return verifier.getFailures().empty();
+}
+
+static void runPeek(DatFile& dat_file, const CommandLine& command_line) {
+	const auto& positionals = command_line.getPositionals();
+	if (positionals.size() < 3) {
+		throw std::invalid_argument("peek expects an MFT index");
+	}
+	uint64_t index = std::strtoull(positionals[2].c_str(), nullptr, 10);
+	if (index >= dat_file.getMftData().size()) {
+		throw std::out_of_range("MFT index out of range: " + std::to_string(index));
+	}
+	const DatFile::MftData& entry = dat_file.getMftData()[index];
+
+	size_t length = static_cast<size_t>(command_line.getNumber("bytes", 64));
+	uint64_t offset = command_line.getNumber("offset", 0);
+	std::vector<uint8_t> data;
+	auto start = std::chrono::steady_clock::now();
+	if (command_line.has("offset")) {
+		// Checkpoints recorded on the way are saved, so the next jump into the entry is short
+		DatSeekableEntry seekable(dat_file, static_cast<uint32_t>(index), !command_line.has("no-cache"));
+		offset = std::min(offset, seekable.getSize());
+		data.resize(static_cast<size_t>(std::min<uint64_t>(length, seekable.getSize() - offset)));
+		seekable.read(offset, data.data(), data.size());
+		if (!command_line.has("no-cache")) {
+			seekable.saveCheckpoints();
+		}
+	}
+	else {
+		data = dat_file.peekData(entry, length);
+	}
+	double seconds = secondsSince(start);
+
+	std::cout << "Entry " << index << ": " << entry.size << " bytes" << (entry.compression_flag != 0 ? ", compressed" : "");
+	if (offset == 0) {
+		std::cout << ", type " << DatClassifier::typeName(data.empty() ? DatFileType::Empty : DatClassifier::sniff(data.data(), data.size()));
+	}
+	std::cout << "\n";
+	for (size_t line = 0; line < data.size(); line += 16) {
+		size_t count = std::min<size_t>(16, data.size() - line);
+		std::printf("%08llx  ", static_cast<unsigned long long>(offset + line));
+		for (size_t i = 0; i < 16; ++i) {
+			if (i < count) {
+				std::printf("%02x ", data[line + i]);
+			}
+			else {
+				std::printf("   ");
+			}
+		}
+		std::printf(" ");
+		for (size_t i = 0; i < count; ++i) {
+			uint8_t byte = data[line + i];
+			std::putchar(byte >= 0x20 && byte < 0x7F ? byte : '.');
+		}
+		std::printf("\n");
+	}
+	std::cerr << data.size() << " bytes in " << seconds * 1e6 << " us\n";
+}
+
+static void runSearch(DatFile& dat_file, const CommandLine& command_line) {
+	const auto& positionals = command_line.getPositionals();
+	if (positionals.size() < 3) {
+		throw std::invalid_argument("search expects a number");
+	}
+	uint32_t query = static_cast<uint32_t>(std::strtoul(positionals[2].c_str(), nullptr, 10));
+	bool is_base_id = !command_line.has("file-id");
+
+	std::vector<uint32_t> page;
+	size_t total;
+	auto start = std::chrono::steady_clock::now();
+	if (command_line.has("exact")) {
+		page = dat_file.findMftDataExact(query, is_base_id);
+		total = page.size();
+	}
+	else {
+		DatSearchIndex::Results results = dat_file.searchMftData(query, is_base_id);
+		total = results.size();
+		page = results.page(command_line.getNumber("offset", 0), command_line.getNumber("count", 100));
+	}
+	double seconds = secondsSince(start);
+
+	for (uint32_t mft_index : page) {
+		std::cout << mft_index << '\n';
+	}
+	std::cerr << total << " matches, " << page.size() << " shown, " << seconds * 1e6 << " us\n";
+}
+
+// Reads the entries in order through io_uring, as many as fit a buffer per batch, and returns
+// the bytes read; entries larger than a buffer are read on their own
+static uint64_t readBatched(DatFile& dat_file, UringReader& reader, const std::vector<uint32_t>& order) {
+	const auto& mft_data = dat_file.getMftData();
+	std::vector<UringReader::Range> ranges;
+	uint64_t bytes = 0;
+	size_t next_buffer = 0;
+	auto submit = [&] {
+		if (ranges.empty()) {
+			return;
+		}
+		bool ok = true;
+		size_t buffer_index = next_buffer < reader.getBufferCount() ? next_buffer++ : reader.wait(ok);
+		if (!ok) {
+			throw std::runtime_error("Batched read failed");
+		}
+		reader.submit(buffer_index, ranges.data(), ranges.size());
+		ranges.clear();
+	};
+
+	uint64_t batch_bytes = 0;
+	for (uint32_t index : order) {
+		const DatFile::MftData& entry = mft_data[index];
+		if (entry.size > reader.getBufferSize()) {
+			bytes += dat_file.readCompressedData(entry).size();
+			continue;
+		}
+		if (batch_bytes + entry.size > reader.getBufferSize()) {
+			submit();
+			batch_bytes = 0;
+		}
+		ranges.push_back({ entry.offset, entry.size });
+		batch_bytes += entry.size;
+		bytes += entry.size;
+	}
+	submit();
+	while (reader.pendingCount() != 0) {
+		bool ok;
+		reader.wait(ok);
+		if (!ok) {
+			throw std::runtime_error("Batched read failed");
+		}
+	}
+	return bytes;
+}
+
+static void runBench(DatFile& dat_file, const CommandLine& command_line) {
+	const auto& mft_data = dat_file.getMftData();
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < mft_data.size(); ++i) {
+		if (mft_data[i].size != 0) {
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return mft_data[a].offset < mft_data[b].offset;
+	});
+	order.resize(std::min<uint64_t>(order.size(), command_line.getNumber("count", order.size())));
+
+	uint64_t raw_bytes = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t index : order) {
+		raw_bytes += dat_file.readCompressedData(mft_data[index]).size();
+	}
+	double read_seconds = secondsSince(start);
+
+	DatReadScheduler scheduler(dat_file);
+	uint64_t coalesced_bytes = 0;
+	start = std::chrono::steady_clock::now();
+	scheduler.read(order, [&](uint32_t, ByteSpan raw) {
+		coalesced_bytes += raw.size;
+	}, [](uint32_t, const std::exception&) {});
+	double coalesced_seconds = secondsSince(start);
+	const DatReadScheduler::Stats& stats = scheduler.getStats();
+
+	uint64_t batched_bytes = 0;
+	double batched_seconds = 0.0;
+	std::unique_ptr<UringReader> reader = dat_file.createUringReader(4, 8u << 20);
+	if (reader) {
+		start = std::chrono::steady_clock::now();
+		batched_bytes = readBatched(dat_file, *reader, order);
+		batched_seconds = secondsSince(start);
+	}
+
+	// What a metadata scan needs of each entry: its first bytes, decompressed
+	uint64_t peek_failures = 0;
+	DatDecompressor decompressor;
+	start = std::chrono::steady_clock::now();
+	for (uint32_t index : order) {
+		uint8_t head[32];
+		try {
+			dat_file.peekData(mft_data[index], head, sizeof(head), decompressor);
+		}
+		catch (const std::exception&) {
+			++peek_failures;
+		}
+	}
+	double peek_seconds = secondsSince(start);
+
+	uint64_t decoded_bytes = 0;
+	uint64_t failures = 0;
+	start = std::chrono::steady_clock::now();
+	for (uint32_t index : order) {
+		try {
+			decoded_bytes += dat_file.readDecompressedData(mft_data[index]).size();
+		}
+		catch (const std::exception&) {
+			++failures;
+		}
+	}
+	double decode_seconds = secondsSince(start);
+
+	std::printf("entries            %zu\n", order.size());
+	std::printf("read               %.3f s  %.1f MB/s  %.0f entries/s\n", read_seconds,
+		raw_bytes / 1e6 / read_seconds, order.size() / read_seconds);
+	std::printf("read (coalesced)   %.3f s  %.1f MB/s  %.0f entries/s  (%llu reads, %.1f MB of gaps)\n", coalesced_seconds,
+		coalesced_bytes / 1e6 / coalesced_seconds, order.size() / coalesced_seconds, static_cast<unsigned long long>(stats.reads),
+		stats.gap_bytes / 1e6);
+	if (reader) {
+		std::printf("read (io_uring)    %.3f s  %.1f MB/s  %.0f entries/s  (%s buffers)\n", batched_seconds,
+			batched_bytes / 1e6 / batched_seconds, order.size() / batched_seconds, reader->isRegistered() ? "registered" : "unregistered");
+	}
+	std::printf("peek 32 bytes      %.3f s  %.0f entries/s  (%llu failed)\n", peek_seconds, order.size() / peek_seconds,
+		static_cast<unsigned long long>(peek_failures));
+	std::printf("read+decompress    %.3f s  %.1f MB/s out  %.0f entries/s  (%llu failed)\n", decode_seconds,
+		decoded_bytes / 1e6 / decode_seconds, order.size() / decode_seconds, static_cast<unsigned long long>(failures));
+}
+
+// Opens the archive repeatedly in both read modes: parsing the MFT with the cache off (nocache),
+// with the cache on but missing, as on a first launch (cold), and from the cache (warm).
+// Everything the viewer needs before its first frame is loaded by the DatFile constructor; the
+// first search also needs the search index, which only a warm start has ready. The cache a
+// cold start leaves behind is written later, off the load path, and timed on its own.
+static void runStartup(const std::string& file_path, const CommandLine& command_line) {
+	uint64_t iterations = std::max<uint64_t>(1, command_line.getNumber("iterations", 10));
+	const std::string cache_path = DatCache::pathFor(file_path);
+
+	enum class Start { NoCache, Cold, Warm };
+	const char* start_names[] = { "nocache", "cold", "warm" };
+	const DatFile::ReadMode modes[] = { DatFile::ReadMode::Stream, DatFile::ReadMode::Mapped };
+	for (DatFile::ReadMode mode : modes) {
+		for (Start start_kind : { Start::NoCache, Start::Cold, Start::Warm }) {
+			std::vector<double> load_times;
+			std::vector<double> search_times;
+			std::vector<double> write_times;
+			size_t entry_count = 0;
+			for (uint64_t i = 0; i < iterations; ++i) {
+				if (start_kind == Start::Cold) {
+					std::remove(cache_path.c_str());
+				}
+				auto start = std::chrono::steady_clock::now();
+				DatFile dat_file(file_path, mode, start_kind != Start::NoCache);
+				load_times.push_back(secondsSince(start));
+				entry_count = dat_file.getMftData().size();
+				dat_file.searchMftData(1, true);
+				search_times.push_back(secondsSince(start));
+
+				if (start_kind == Start::Cold) {
+					auto write_start = std::chrono::steady_clock::now();
+					if (!dat_file.writeCache()) {
+						std::cerr << "Failed to write MFT cache " << cache_path << "\n";
+					}
+					write_times.push_back(secondsSince(write_start));
+				}
+			}
+			std::sort(load_times.begin(), load_times.end());
+			std::sort(search_times.begin(), search_times.end());
+
+			std::printf("%-6s %-7s %zu entries  load min %.2f ms  median %.2f ms  first search median %.2f ms",
+				mode == DatFile::ReadMode::Mapped ? "mapped" : "stream", start_names[static_cast<int>(start_kind)], entry_count,
+				load_times.front() * 1000.0, load_times[load_times.size() / 2] * 1000.0, search_times[search_times.size() / 2] * 1000.0);
+			if (!write_times.empty()) {
+				std::sort(write_times.begin(), write_times.end());
+				std::printf("  cache write median %.2f ms", write_times[write_times.size() / 2] * 1000.0);
+			}
+			std::printf("\n");
+		}
+	}
+}
+
+static void runGenerate(const std::string& file_path, const CommandLine& command_line) {
+	DatGenerator::Options options;
+	options.entry_count = command_line.getNumber("entries", options.entry_count);
+	options.mean_entry_size = static_cast<uint32_t>(command_line.getNumber("mean-size", options.mean_entry_size));
+	options.compressed_percent = static_cast<uint32_t>(std::min<uint64_t>(100, command_line.getNumber("compressed", options.compressed_percent)));
+	options.empty_percent = std::min(options.empty_percent, 100 - options.compressed_percent);
+	options.seed = command_line.getNumber("seed", options.seed);
+
+	auto start = std::chrono::steady_clock::now();
+	DatGenerator::Progress progress = DatGenerator::generate(file_path, options, [&](const DatGenerator::Progress& progress) {
+		double seconds = secondsSince(start);
+		std::fprintf(stderr, "\r%llu/%llu entries, %.2f GB, %.1f MB/s    ", static_cast<unsigned long long>(progress.entries_done),
+			static_cast<unsigned long long>(progress.entries_total), progress.bytes_written / 1e9,
+			seconds > 0 ? progress.bytes_written / 1e6 / seconds : 0.0);
+	});
+	std::fprintf(stderr, "\n");
+	std::cout << "Wrote " << progress.entries_done << " entries (" << progress.bytes_written << " bytes) to " << file_path
+		<< " in " << secondsSince(start) << " s\n";
+}
+
+int main(int argc, char** argv) {
+	try {
+		CommandLine command_line(argc, argv);
+		const auto& positionals = command_line.getPositionals();
+		if (positionals.size() < 2) {
+			printUsage();
+			return 2;
+		}
+
+		const std::string& command = positionals[0];
+		if (command == "startup") {
+			runStartup(positionals[1], command_line);
+			return 0;
+		}
+		if (command == "generate") {
+			runGenerate(positionals[1], command_line);
+			return 0;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		DatFile dat_file(positionals[1], command_line.has("stream") ? DatFile::ReadMode::Stream : DatFile::ReadMode::Mapped,
+			!command_line.has("no-cache"));
+		double load_seconds = secondsSince(start);
+		int status = 0;
+
+		if (command == "info") {
+			runInfo(dat_file);
+			std::cout << "Load Time: " << load_seconds * 1000.0 << " ms\n";
+		}
+		else if (command == "list") {
+			runList(dat_file, command_line);
+		}
+		else if (command == "extract") {
+			runExtract(dat_file, command_line);
+		}
+		else if (command == "verify") {
+			status = runVerify(dat_file, command_line) ? 0 : 1;
+		}
+		else if (command == "classify") {
+			runClassify(dat_file, command_line);
+		}
+		else if (command == "peek") {
+			runPeek(dat_file, command_line);
+		}
+		else if (command == "search") {
+			runSearch(dat_file, command_line);
+		}
+		else if (command == "bench") {
+			std::printf("load               %.3f s\n", load_seconds);
+			runBench(dat_file, command_line);
+		}
+		else {
+			printUsage();
+			return 2;
+		}
+
+		// After the command, so a cold start is timed like the viewer's
+		if (!dat_file.writeCache()) {
+			std::cerr << "Failed to write MFT cache " << DatCache::pathFor(positionals[1]) << "\n";
+		}
+		return status;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return 1;
+	}
+}
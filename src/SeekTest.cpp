@@ -0,0 +1,192 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "DatWriter.h"
+#include "DatSeekableEntry.h"
+
+// Checks DatSeekableEntry against a whole-entry decompression. A small archive is written with
+// one compressed entry spanning many checkpoint intervals; reads at random offsets must match
+// readDecompressedData before the entry is indexed, after indexing, and again once the
+// checkpoints come back from the sidecar. Caches go to a folder of their own next to the test,
+// which is deleted at the end.
+
+static const char* ARCHIVE_PATH = "seek-test.dat";
+static const char* CACHE_DIRECTORY = "seek-test-cache";
+static const uint64_t INTERVAL = 64 * 1024;
+static const size_t ENTRY_SIZE = 3 * 1024 * 1024 + 12345;
+static const int READS_PER_PASS = 64;
+
+static bool check(const std::string& name, bool passed) {
+	std::cout << (passed ? "PASS " : "FAIL ") << name << "\n";
+	return passed;
+}
+
+// Text-like bytes with the odd random one, so the entry compresses but has varied copies
+static std::vector<uint8_t> makeEntryData(size_t size) {
+	std::mt19937 rng(1234);
+	std::vector<uint8_t> data(size);
+	for (uint8_t& byte : data) {
+		byte = rng() % 16 == 0 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>('a' + rng() % 6);
+	}
+	return data;
+}
+
+// Random offsets, plus the first and last bytes of the entry and a read across an interval
+static bool readsMatch(DatSeekableEntry& seekable, const std::vector<uint8_t>& expected, uint32_t seed, bool non_blocking) {
+	std::mt19937_64 rng(seed);
+	for (int i = 0; i < READS_PER_PASS + 2; ++i) {
+		uint64_t offset = i == 0 ? 0 : i == 1 ? expected.size() - 1 : rng() % expected.size();
+		size_t length = static_cast<size_t>(std::min<uint64_t>(1 + rng() % (2 * INTERVAL), expected.size() - offset));
+		std::vector<uint8_t> bytes(length);
+		if (non_blocking) {
+			while (!seekable.tryRead(offset, bytes.data(), length)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		else {
+			seekable.read(offset, bytes.data(), length);
+		}
+		if (std::memcmp(bytes.data(), expected.data() + offset, length) != 0) {
+			std::cout << "  mismatch at offset " << offset << ", length " << length << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool fileExists(const std::string& path) {
+	return std::ifstream(path).good();
+}
+
+static bool testMode(DatFile::ReadMode mode, const std::string& name) {
+	DatFile dat_file(ARCHIVE_PATH, mode, false);
+	const DatFile::MftData& entry = dat_file.getMftData()[DatWriter::FIRST_ENTRY_INDEX];
+	std::vector<uint8_t> expected = dat_file.readDecompressedData(entry);
+	bool passed = check(name + " whole entry", entry.compression_flag != 0 && expected == makeEntryData(ENTRY_SIZE));
+
+	{
+		DatSeekableEntry cold(dat_file, DatWriter::FIRST_ENTRY_INDEX, false, INTERVAL);
+		passed &= check(name + " size", cold.getSize() == expected.size());
+		passed &= check(name + " read", readsMatch(cold, expected, 1, false));
+		passed &= check(name + " tryRead", readsMatch(cold, expected, 2, true));
+	}
+
+	std::string sidecar_path;
+	{
+		DatSeekableEntry seekable(dat_file, DatWriter::FIRST_ENTRY_INDEX, true, INTERVAL);
+		sidecar_path = seekable.sidecarPath();
+		seekable.startIndexing();
+		passed &= check(name + " tryRead while indexing", readsMatch(seekable, expected, 3, true));
+		while (!seekable.isIndexed() && seekable.getIndexError().empty()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		passed &= check(name + " indexed", seekable.isIndexed());
+		passed &= check(name + " read indexed", readsMatch(seekable, expected, 4, false));
+	}
+	// The indexer saves the sidecar before the destructor joins it
+	passed &= check(name + " sidecar in cache directory",
+		fileExists(sidecar_path) && sidecar_path.compare(0, std::strlen(CACHE_DIRECTORY), CACHE_DIRECTORY) == 0);
+
+	{
+		DatSeekableEntry reloaded(dat_file, DatWriter::FIRST_ENTRY_INDEX, true, INTERVAL);
+		std::vector<uint8_t> first(1);
+		reloaded.read(0, first.data(), first.size());
+		passed &= check(name + " sidecar reloaded", reloaded.isIndexed());
+		passed &= check(name + " read reloaded", readsMatch(reloaded, expected, 5, false));
+		passed &= check(name + " tryRead reloaded", readsMatch(reloaded, expected, 6, true));
+	}
+
+	// A stale interval must ignore the sidecar rather than misuse it
+	{
+		DatSeekableEntry other_interval(dat_file, DatWriter::FIRST_ENTRY_INDEX, true, 2 * INTERVAL);
+		passed &= check(name + " read other interval", readsMatch(other_interval, expected, 7, false));
+	}
+
+	std::string folder = DatSeekableEntry::sidecarFolder(ARCHIVE_PATH);
+	passed &= check(name + " trim to budget", DatSeekableEntry::trimSidecars(folder, 0) == 0 && !fileExists(sidecar_path));
+	return passed;
+}
+
+// The oldest sidecars go first, and the one passed as keep stays even past the budget
+static bool testTrim() {
+	std::string folder = DatSeekableEntry::sidecarFolder(ARCHIVE_PATH);
+	DatCache::makeDirectories(folder);
+	const char* names[] = { "old", "middle", "new" };
+	for (int i = 0; i < 3; ++i) {
+		std::string path = folder + "/" + names[i];
+		std::ofstream(path, std::ios::binary) << std::string(1000, 'x');
+#ifdef _WIN32
+		struct _utimbuf times;
+		times.actime = times.modtime = 1000000000 + i * 100;
+		_utime(path.c_str(), &times);
+#else
+		struct utimbuf times;
+		times.actime = times.modtime = 1000000000 + i * 100;
+		utime(path.c_str(), &times);
+#endif
+	}
+	bool passed = check("trim oldest first", DatSeekableEntry::trimSidecars(folder, 2000) == 2000 &&
+		!fileExists(folder + "/old") && fileExists(folder + "/middle") && fileExists(folder + "/new"));
+	passed &= check("trim spares keep", DatSeekableEntry::trimSidecars(folder, 0, folder + "/middle") == 1000 &&
+		fileExists(folder + "/middle") && !fileExists(folder + "/new"));
+	DatSeekableEntry::trimSidecars(folder, 0);
+	return passed;
+}
+
+static void setCacheDirectory(const char* path) {
+#ifdef _WIN32
+	_putenv_s("GW2VIEWER_CACHE_DIR", path);
+#else
+	setenv("GW2VIEWER_CACHE_DIR", path, 1);
+#endif
+}
+
+static void removeDirectory(const std::string& path) {
+#ifdef _WIN32
+	_rmdir(path.c_str());
+#else
+	rmdir(path.c_str());
+#endif
+}
+
+int main() {
+	setCacheDirectory(CACHE_DIRECTORY);
+	bool passed = true;
+	try {
+		{
+			std::vector<uint8_t> data = makeEntryData(ENTRY_SIZE);
+			DatWriter writer(ARCHIVE_PATH);
+			writer.addEntry(data.data(), data.size(), true);
+			writer.finish();
+		}
+		passed &= testMode(DatFile::ReadMode::Mapped, "mapped");
+		passed &= testMode(DatFile::ReadMode::Stream, "stream");
+		passed &= testTrim();
+	}
+	catch (const std::exception& e) {
+		passed = check(std::string("exception: ") + e.what(), false);
+	}
+
+	std::string folder = DatSeekableEntry::sidecarFolder(ARCHIVE_PATH);
+	DatSeekableEntry::trimSidecars(folder, 0);
+	removeDirectory(folder);
+	removeDirectory(CACHE_DIRECTORY);
+	std::remove(ARCHIVE_PATH);
+	return passed ? 0 : 1;
+}
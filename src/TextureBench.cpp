@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define STB_DXT_IMPLEMENTATION
+#include "stb_dxt.h"
+
+#include "TextureDecoder.h"
+
+// Throughput benchmark for TextureDecoder::decodeBlocks on BCn surfaces encoded from a
+// synthetic image, comparing the SSSE3 and scalar paths.
+// Usage: gw2viewer-texture-bench [size_in_pixels] [iterations]
+
+// Smooth gradients with some noise and a soft alpha ramp
+static std::vector<uint8_t> makeImage(uint32_t size, std::mt19937& rng) {
+	std::vector<uint8_t> rgba(static_cast<size_t>(size) * size * 4);
+	for (uint32_t y = 0; y < size; ++y) {
+		for (uint32_t x = 0; x < size; ++x) {
+			uint8_t* pixel = &rgba[(static_cast<size_t>(y) * size + x) * 4];
+			int noise = static_cast<int>(rng() % 16) - 8;
+			pixel[0] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(x * 255 / size) + noise)));
+			pixel[1] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(y * 255 / size) + noise)));
+			pixel[2] = static_cast<uint8_t>(128 + 127 * std::sin((x + y) * 0.05));
+			pixel[3] = static_cast<uint8_t>((x + y) * 255 / (2 * size));
+		}
+	}
+	return rgba;
+}
+
+static std::vector<uint8_t> encode(TextureDecoder::BlockFormat format, const std::vector<uint8_t>& rgba, uint32_t size) {
+	std::vector<uint8_t> blocks;
+	uint8_t block_pixels[64];
+	uint8_t block[16];
+	for (uint32_t block_y = 0; block_y < size; block_y += 4) {
+		for (uint32_t block_x = 0; block_x < size; block_x += 4) {
+			for (uint32_t row = 0; row < 4; ++row) {
+				std::memcpy(block_pixels + row * 16, &rgba[(static_cast<size_t>(block_y + row) * size + block_x) * 4], 16);
+			}
+
+			switch (format) {
+			case TextureDecoder::BlockFormat::BC1:
+				stb_compress_dxt_block(block, block_pixels, 0, STB_DXT_NORMAL);
+				break;
+			case TextureDecoder::BlockFormat::BC2:
+				// Explicit 4-bit alpha followed by a BC1 colour block
+				for (int i = 0; i < 8; ++i) {
+					block[i] = static_cast<uint8_t>((block_pixels[i * 8 + 3] >> 4) | (block_pixels[i * 8 + 7] & 0xF0));
+				}
+				stb_compress_dxt_block(block + 8, block_pixels, 0, STB_DXT_NORMAL);
+				break;
+			case TextureDecoder::BlockFormat::BC3:
+				stb_compress_dxt_block(block, block_pixels, 1, STB_DXT_NORMAL);
+				break;
+			case TextureDecoder::BlockFormat::BC5: {
+				uint8_t red_green[32];
+				for (int i = 0; i < 16; ++i) {
+					red_green[i * 2] = block_pixels[i * 4];
+					red_green[i * 2 + 1] = block_pixels[i * 4 + 1];
+				}
+				stb_compress_bc5_block(block, red_green);
+				break;
+			}
+			}
+			blocks.insert(blocks.end(), block, block + TextureDecoder::blockSize(format));
+		}
+	}
+	return blocks;
+}
+
+// PSNR over the channels the format stores
+static double psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int channels) {
+	double squared_error = 0.0;
+	size_t samples = 0;
+	for (size_t i = 0; i < a.size(); i += 4) {
+		for (int c = 0; c < channels; ++c) {
+			double difference = static_cast<double>(a[i + c]) - b[i + c];
+			squared_error += difference * difference;
+			++samples;
+		}
+	}
+	double mse = squared_error / samples;
+	return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+static double timeDecode(TextureDecoder::BlockFormat format, const std::vector<uint8_t>& blocks, uint32_t size,
+	std::vector<uint8_t>& output, int iterations, bool allow_simd) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		TextureDecoder::decodeBlocks(format, blocks.data(), size, size, output.data(), allow_simd);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return static_cast<double>(size) * size * iterations / seconds / 1e6;
+}
+
+static bool runCase(const char* name, TextureDecoder::BlockFormat format, int channels, const std::vector<uint8_t>& image,
+	uint32_t size, int iterations) {
+	std::vector<uint8_t> blocks = encode(format, image, size);
+	std::vector<uint8_t> scalar_output(image.size());
+	std::vector<uint8_t> simd_output(image.size());
+
+	double scalar_rate = timeDecode(format, blocks, size, scalar_output, iterations, false);
+	double simd_rate = timeDecode(format, blocks, size, simd_output, iterations, true);
+	if (simd_output != scalar_output) {
+		std::printf("%-4s  MISMATCH between SIMD and scalar output\n", name);
+		return false;
+	}
+
+	std::printf("%-4s  scalar %8.1f MP/s   simd %8.1f MP/s   PSNR %.1f dB\n", name, scalar_rate, simd_rate,
+		psnr(image, simd_output, channels));
+	return true;
+}
+
+int main(int argc, char** argv) {
+	uint32_t size = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 2048;
+	int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+	size = std::max<uint32_t>(4, size & ~3u);
+
+	std::mt19937 rng(12345);
+	std::vector<uint8_t> image = makeImage(size, rng);
+
+	std::printf("%ux%u, %d iterations, SSSE3 %s\n", size, size, iterations,
+		TextureDecoder::hasSimdSupport() ? "available" : "unavailable");
+
+	bool ok = true;
+	ok &= runCase("BC1", TextureDecoder::BlockFormat::BC1, 3, image, size, iterations);
+	ok &= runCase("BC2", TextureDecoder::BlockFormat::BC2, 4, image, size, iterations);
+	ok &= runCase("BC3", TextureDecoder::BlockFormat::BC3, 4, image, size, iterations);
+	ok &= runCase("BC5", TextureDecoder::BlockFormat::BC5, 2, image, size, iterations);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+#include "TextureDecoder.h"
+
+// Known-answer test for TextureDecoder::inflateBlocks. The packed payloads below were written
+// bit by bit from the format description by a separate encoder, which also worked out the
+// expected blocks, so the run tree, the plain colour rounding and the raw word order are not
+// only checked against themselves.
+//
+// DXT5, 16x8 (8 blocks): transparent block 0; 8-bit alpha 0x80 on blocks 1 and 2, alpha 0 on
+//   block 3; plain colour (200, 100, 50) on block 3; raw alpha for blocks 4-7 and raw colour
+//   for blocks 1, 2 and 4-7.
+// DXT1, 16x24 (24 blocks): plain colour (30, 130, 220) in runs of 18 and 4 around two raw
+//   blocks, exercising the 2-bit code of 18 and BC1's midpoint colour.
+
+static const uint8_t PACKED_DXT5[] = {
+	0x64, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00, 0xE3, 0x1F, 0x40, 0xCA, 0x47, 0x86, 0x0C, 0x59,
+	0x00, 0x00, 0x40, 0xB3, 0xA6, 0x7E, 0xC6, 0x41, 0xE7, 0xB0, 0x7E, 0x96, 0x94, 0xE4, 0x81, 0x27,
+	0x3D, 0x9B, 0x6B, 0xC4, 0x32, 0xDF, 0x4B, 0xF9, 0x83, 0x74, 0xFB, 0x95, 0x00, 0xB6, 0xE2, 0xD9,
+	0x39, 0xAE, 0xFB, 0x9C, 0x13, 0xCD, 0x8C, 0x83, 0x50, 0x4B, 0x21, 0x59, 0x49, 0xA1, 0xFF, 0xA7,
+	0x4E, 0x1A, 0x72, 0xB2, 0x6F, 0x27, 0xED, 0xE4, 0x7C, 0xCC, 0xD7, 0x69, 0x05, 0x09, 0x18, 0x75,
+	0x5A, 0x8D, 0xD9, 0x6C, 0x8B, 0xCB, 0x4E, 0xCF, 0x68, 0x34, 0x13, 0xFF, 0x81, 0x30, 0x95, 0x65,
+	0x26, 0x25, 0x13, 0xFA,
+};
+
+static const uint8_t EXPECTED_DXT5[] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0xCD, 0x8C, 0x83, 0x05, 0x09, 0x18, 0x75,
+	0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x4B, 0x21, 0x59, 0x5A, 0x8D, 0xD9, 0x6C,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x27, 0xCB, 0x06, 0xC3, 0x55, 0x55, 0x55, 0x55,
+	0xA6, 0x7E, 0xC6, 0x41, 0xE7, 0xB0, 0x7E, 0x96, 0x49, 0xA1, 0xFF, 0xA7, 0x8B, 0xCB, 0x4E, 0xCF,
+	0x94, 0xE4, 0x81, 0x27, 0x3D, 0x9B, 0x6B, 0xC4, 0x4E, 0x1A, 0x72, 0xB2, 0x68, 0x34, 0x13, 0xFF,
+	0x32, 0xDF, 0x4B, 0xF9, 0x83, 0x74, 0xFB, 0x95, 0x6F, 0x27, 0xED, 0xE4, 0x81, 0x30, 0x95, 0x65,
+	0x00, 0xB6, 0xE2, 0xD9, 0x39, 0xAE, 0xFB, 0x9C, 0x7C, 0xCC, 0xD7, 0x69, 0x26, 0x25, 0x13, 0xFA,
+};
+
+static const uint8_t PACKED_DXT1[] = {
+	0x20, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x67, 0xDC, 0x82, 0x1E, 0x00, 0x00, 0x80, 0x8D,
+	0x80, 0x1B, 0x53, 0xC5, 0xB9, 0xE5, 0xC3, 0x1B, 0xFE, 0x5D, 0x7D, 0x28, 0x5F, 0x99, 0x78, 0xA0,
+};
+
+static const uint8_t EXPECTED_DXT1[] = {
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x80, 0x1B, 0x53, 0xC5, 0xFE, 0x5D, 0x7D, 0x28, 0xB9, 0xE5, 0xC3, 0x1B, 0x5F, 0x99, 0x78, 0xA0,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+	0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA, 0x1B, 0x24, 0x1A, 0x1C, 0xAA, 0xAA, 0xAA, 0xAA,
+};
+
+static bool check(const std::string& name, bool passed) {
+	std::cout << (passed ? "PASS " : "FAIL ") << name << "\n";
+	return passed;
+}
+
+static bool testInflate(const std::string& name, TextureDecoder::BlockFormat format, uint32_t width, uint32_t height,
+	const uint8_t* packed, size_t packed_size, const uint8_t* expected, size_t expected_size) {
+	std::vector<uint8_t> blocks = TextureDecoder::inflateBlocks(format, width, height, packed, packed_size);
+	return check(name, blocks.size() == expected_size && std::memcmp(blocks.data(), expected, expected_size) == 0);
+}
+
+// Whole file through decode(): the transparent block has alpha 0, the plain one the colour
+static bool testDecode() {
+	std::vector<uint8_t> file(TextureDecoder::HEADER_SIZE);
+	uint16_t width = 16;
+	uint16_t height = 8;
+	std::memcpy(file.data(), "ATEX", 4);
+	std::memcpy(file.data() + 4, "DXT5", 4);
+	std::memcpy(file.data() + 8, &width, 2);
+	std::memcpy(file.data() + 10, &height, 2);
+	file.insert(file.end(), PACKED_DXT5, PACKED_DXT5 + sizeof(PACKED_DXT5));
+
+	TextureDecoder::Header header;
+	std::vector<uint8_t> rgba = TextureDecoder::decode(file.data(), file.size(), header);
+	if (rgba.size() != static_cast<size_t>(width) * height * 4) {
+		return check("decode", false);
+	}
+	const uint8_t* transparent = &rgba[0];
+	const uint8_t* plain = &rgba[12 * 4]; // block 3, top left pixel
+	bool passed = transparent[3] == 0 && plain[3] == 0 &&
+		std::abs(plain[0] - 200) <= 8 && std::abs(plain[1] - 100) <= 8 && std::abs(plain[2] - 50) <= 8;
+	return check("decode", passed);
+}
+
+// A cut payload leaves blocks zero or throws, it never reads past its end
+static bool testTruncated() {
+	bool passed = true;
+	for (size_t cut = 0; cut < sizeof(PACKED_DXT5); cut += 4) {
+		try {
+			std::vector<uint8_t> blocks = TextureDecoder::inflateBlocks(TextureDecoder::BlockFormat::BC3, 16, 8, PACKED_DXT5, cut);
+			passed &= blocks.size() == sizeof(EXPECTED_DXT5);
+		}
+		catch (const std::runtime_error&) {
+		}
+	}
+	return check("truncated payload", passed);
+}
+
+int main() {
+	try {
+		bool passed = testInflate("inflate DXT5", TextureDecoder::BlockFormat::BC3, 16, 8, PACKED_DXT5, sizeof(PACKED_DXT5),
+			EXPECTED_DXT5, sizeof(EXPECTED_DXT5));
+		passed &= testInflate("inflate DXT1", TextureDecoder::BlockFormat::BC1, 16, 24, PACKED_DXT1, sizeof(PACKED_DXT1),
+			EXPECTED_DXT1, sizeof(EXPECTED_DXT1));
+		passed &= testDecode();
+		passed &= testTruncated();
+		return passed ? 0 : 1;
+	}
+	catch (const std::exception& e) {
+		std::cout << "FAIL " << e.what() << "\n";
+		return 1;
+	}
+}